@@ -0,0 +1,244 @@
+//------------------------------------------------------------------------------
+// profiler.cc
+// (C) 2015-2016 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Core
+{
+
+namespace
+{
+
+/// begin event if name is set, end event otherwise
+struct Event
+{
+	const char* name;
+	int64_t time;
+};
+
+/// events of one thread, only that thread writes to it
+struct ThreadBuffer
+{
+	int id;
+	std::string name;
+	std::unique_ptr<Event[]> events;
+
+	/// events written, published to the exporter with release stores
+	std::atomic<int> count;
+	/// zones recorded but not ended yet, their end events always have room
+	int openZones;
+	/// zones that did not fit
+	std::atomic<int> dropped;
+};
+
+std::atomic<bool> recording(false);
+
+typedef std::chrono::steady_clock Clock;
+Clock::time_point epoch = Clock::now();
+
+/// every thread that has recorded something, buffers live until the process exits
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+thread_local ThreadBuffer* threadBuffer = nullptr;
+
+//------------------------------------------------------------------------------
+/**
+	Buffer of the calling thread, created the first time the thread records
+*/
+ThreadBuffer*
+GetThreadBuffer()
+{
+	if (threadBuffer == nullptr)
+	{
+		std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+		buffer->events.reset(new Event[Profiler::EventsPerThread]);
+		buffer->count = 0;
+		buffer->openZones = 0;
+		buffer->dropped = 0;
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+		buffer->id = registry.size();
+		buffer->name = "Thread " + std::to_string(buffer->id);
+		threadBuffer = buffer.get();
+		registry.push_back(std::move(buffer));
+	}
+	return threadBuffer;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int64_t
+Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+}
+
+//------------------------------------------------------------------------------
+/**
+	Write a string with the characters JSON needs escaped
+*/
+void
+WriteJSONString(FILE* file, const char* s)
+{
+	fputc('"', file);
+	for (; *s != '\0'; s++)
+	{
+		if (*s == '"' || *s == '\\')
+			fputc('\\', file);
+		if ((unsigned char)*s >= 0x20)
+			fputc(*s, file);
+	}
+	fputc('"', file);
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Profiler::Start()
+{
+	recording = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Profiler::Stop()
+{
+	recording = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+Profiler::IsRecording()
+{
+	return recording;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Profiler::SetThreadName(const char* name)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	buffer->name = name;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+Profiler::Begin(const char* name)
+{
+	if (!recording.load(std::memory_order_relaxed))
+		return false;
+
+	ThreadBuffer* buffer = GetThreadBuffer();
+	int count = buffer->count.load(std::memory_order_relaxed);
+
+	// Keep room for this zone's end and the ends of all open zones
+	if (count + buffer->openZones + 2 > EventsPerThread)
+	{
+		buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	buffer->events[count].name = name;
+	buffer->events[count].time = Now();
+	buffer->count.store(count + 1, std::memory_order_release);
+	buffer->openZones++;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Profiler::End()
+{
+	ThreadBuffer* buffer = threadBuffer;
+	assert(buffer != nullptr && buffer->openZones > 0);
+
+	int count = buffer->count.load(std::memory_order_relaxed);
+	buffer->events[count].name = nullptr;
+	buffer->events[count].time = Now();
+	buffer->count.store(count + 1, std::memory_order_release);
+	buffer->openZones--;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Zones still open on other threads are written without their end, the
+	viewer closes them at the end of the trace
+*/
+bool
+Profiler::WriteChromeTrace(const char* filename)
+{
+	FILE* file = fopen(filename, "w");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not write trace to %s\n", filename);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+	bool first = true;
+	for (size_t i = 0; i < registry.size(); i++)
+	{
+		const ThreadBuffer& buffer = *registry[i];
+
+		fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %i, \"args\": {\"name\": ", first ? "" : ",\n", buffer.id);
+		WriteJSONString(file, buffer.name.c_str());
+		fprintf(file, "}}");
+		first = false;
+
+		int count = buffer.count.load(std::memory_order_acquire);
+		for (int j = 0; j < count; j++)
+		{
+			const Event& e = buffer.events[j];
+			double us = e.time / 1000.0;
+
+			if (e.name != nullptr)
+			{
+				fprintf(file, ",\n{\"name\": ");
+				WriteJSONString(file, e.name);
+				fprintf(file, ", \"ph\": \"B\", \"ts\": %.3f, \"pid\": 1, \"tid\": %i}", us, buffer.id);
+			}
+			else
+				fprintf(file, ",\n{\"ph\": \"E\", \"ts\": %.3f, \"pid\": 1, \"tid\": %i}", us, buffer.id);
+		}
+
+		int dropped = buffer.dropped.load(std::memory_order_relaxed);
+		if (dropped > 0)
+			fprintf(stderr, "Profiler: %s was full, %i zones were dropped\n", buffer.name.c_str(), dropped);
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
+
+} // namespace Core
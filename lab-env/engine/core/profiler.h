@@ -0,0 +1,76 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	CPU timeline profiler.
+
+	PROFILE_SCOPE(name) records a begin event where it is declared and an end
+	event when the scope closes. Every thread writes into its own buffer so
+	recording takes no locks, and the buffers can be written as Chrome trace
+	event JSON (chrome://tracing, Perfetto).
+
+	Names are stored as pointers and must outlive the recording, use string
+	literals. The zones compile to nothing unless CORE_PROFILER is set, see
+	the CORE_PROFILER option in core/CMakeLists.txt.
+
+	(C) 2015-2016 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#ifndef CORE_PROFILER
+#define CORE_PROFILER 0
+#endif
+
+namespace Core
+{
+class Profiler
+{
+public:
+	/// events each thread can hold before new zones are dropped
+	static const int EventsPerThread = 1 << 18;
+
+	/// start recording zones on all threads
+	static void Start();
+	/// stop recording, zones that are open still record their end
+	static void Stop();
+	/// true between Start and Stop
+	static bool IsRecording();
+
+	/// name shown for the calling thread in the trace
+	static void SetThreadName(const char* name);
+
+	/// record the start of a zone on the calling thread, returns false if it was not recorded
+	static bool Begin(const char* name);
+	/// record the end of the latest zone that Begin recorded on the calling thread
+	static void End();
+
+	/// write all recorded events as Chrome trace event JSON
+	static bool WriteChromeTrace(const char* filename);
+};
+
+//------------------------------------------------------------------------------
+/**
+	Zone that lasts until the end of the scope
+*/
+class ProfileScope
+{
+public:
+	/// begin the zone
+	ProfileScope(const char* name) : recorded(Profiler::Begin(name)) {}
+	/// end the zone
+	~ProfileScope() { if (this->recorded) Profiler::End(); }
+
+private:
+	ProfileScope(const ProfileScope&);
+	void operator=(const ProfileScope&);
+
+	bool recorded;
+};
+} // namespace Core
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if CORE_PROFILER
+#define PROFILE_SCOPE(name) Core::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
@@ -71,7 +71,8 @@ Window::Window() :
 	height(768),
 	// width(1280),
 	// height(720),
-	title("gscept Lab Environment")
+	title("gscept Lab Environment"),
+	visible(true)
 {
 	// empty
 }
@@ -191,6 +192,9 @@ Window::Open()
 	glfwWindowHint(GLFW_SRGB_CAPABLE, GL_TRUE);
 	glfwWindowHint(GLFW_SAMPLES, 8);
 
+	// hidden windows still get a full context, used for headless runs
+	glfwWindowHint(GLFW_VISIBLE, this->visible ? GL_TRUE : GL_FALSE);
+
 
 
 	// open window
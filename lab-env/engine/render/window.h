@@ -34,6 +34,8 @@ public:
 	int GetHeight();
 	/// set title of window
 	void SetTitle(const std::string& title);
+	/// show or hide the window, must be set before the window is opened
+	void SetVisible(bool visible);
 
 	/// open window
 	bool Open();
@@ -109,6 +111,7 @@ private:
 	int32 width;
 	int32 height;
 	std::string title;
+	bool visible;
 	GLFWwindow* window;
 	NVGcontext * vg;
 };
@@ -146,6 +149,15 @@ Window::SetTitle(const std::string& title)
 	if (nullptr != this->window) this->Retitle();
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Window::SetVisible(bool visible)
+{
+	this->visible = visible;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
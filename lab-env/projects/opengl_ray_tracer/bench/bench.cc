@@ -0,0 +1,506 @@
+//------------------------------------------------------------------------------
+// bench.cc
+// Microbenchmarks for the math library, collision, .obj and .glb parsing and
+// the scene buffer packing and animation. Run from the bin folder like the application.
+//------------------------------------------------------------------------------
+#include "mathMatrix.h"
+#include "mathVec3.h"
+#include "mathVec4.h"
+#include "gameObject.h"
+#include "objParser.h"
+#include "glbParser.h"
+#include "sceneBuffer.h"
+#include "animator.h"
+#include "threadPool.h"
+#include "camera.h"
+#include "GJK.h"
+#include "EPA.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+// Keep the compiler from removing work whose result is unused
+#if defined(__GNUC__)
+static void Escape(const void *p)
+{
+	asm volatile("" : : "g"(p) : "memory");
+}
+#else
+static const void* volatile escapeSink;
+static void Escape(const void *p)
+{
+	escapeSink = p;
+}
+#endif
+
+
+struct Result
+{
+	std::string name;
+	long long iterations;
+	double medianNs;
+	double minNs;
+	double maxNs;
+};
+
+static const int Repetitions = 5;
+static double minTime = 0.1;
+static std::string filter;
+static std::vector<Result> results;
+
+
+// Time fn(n) which does n operations. The count is doubled until one run takes
+// minTime, then that count is run Repetitions times and the median is kept
+static void Benchmark(const char *name, const std::function<void(long long)> &fn)
+{
+	if (!filter.empty() && strstr(name, filter.c_str()) == nullptr)
+		return;
+
+	typedef std::chrono::steady_clock Clock;
+
+	long long n = 1;
+	while (true)
+	{
+		Clock::time_point start = Clock::now();
+		fn(n);
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		if (seconds >= minTime || n >= (1LL << 40))
+			break;
+
+		// Jump close to the target once the timing is meaningful
+		if (seconds > minTime / 100.0)
+			n = std::max(n * 2, (long long)(n * minTime / seconds * 1.2));
+		else
+			n *= 10;
+	}
+
+	std::vector<double> ns;
+	for (int i = 0; i < Repetitions; i++)
+	{
+		Clock::time_point start = Clock::now();
+		fn(n);
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		ns.push_back(seconds * 1e9 / n);
+	}
+	std::sort(ns.begin(), ns.end());
+
+	Result r;
+	r.name = name;
+	r.iterations = n;
+	r.medianNs = ns[Repetitions / 2];
+	r.minNs = ns.front();
+	r.maxNs = ns.back();
+	results.push_back(r);
+
+	printf("%-28s %14.2f ns/op  (min %.2f, max %.2f, %lli ops)\n", name, r.medianNs, r.minNs, r.maxNs, n);
+	fflush(stdout);
+}
+
+static bool WriteJSON(const char *filename)
+{
+	FILE *file = fopen(filename, "w");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not write benchmark results to %s\n", filename);
+		return false;
+	}
+
+	fprintf(file, "{\n\"benchmarks\": [\n");
+	for (unsigned int i = 0; i < results.size(); i++)
+	{
+		const Result &r = results[i];
+		fprintf(file, "\t{\"name\": \"%s\", \"ns_per_op\": %f, \"min_ns\": %f, \"max_ns\": %f, \"iterations\": %lli}%s\n",
+			r.name.c_str(), r.medianNs, r.minNs, r.maxNs, r.iterations, (i + 1 < results.size()) ? "," : "");
+	}
+	fprintf(file, "]\n}\n");
+
+	fclose(file);
+	return true;
+}
+
+
+// Pseudo random inputs so nothing can be constant folded
+static float RandomFloat()
+{
+	return rand() / float(RAND_MAX) * 2.0f - 1.0f;
+}
+
+static Matrix RandomTransform()
+{
+	Matrix m(Vec3(RandomFloat(), RandomFloat(), RandomFloat()).Normal(), RandomFloat() * 180.0f);
+	m.SetPosition(RandomFloat(), RandomFloat(), RandomFloat());
+	return m;
+}
+
+
+static void MathBenchmarks()
+{
+	const int Count = 1024;
+	const int Mask = Count - 1;
+
+	std::vector<Vec3> a3(Count), b3(Count);
+	std::vector<Vec4> a4(Count), b4(Count);
+	std::vector<Matrix> am(Count), bm(Count);
+	for (int i = 0; i < Count; i++)
+	{
+		a3[i] = Vec3(RandomFloat(), RandomFloat(), RandomFloat());
+		b3[i] = Vec3(RandomFloat(), RandomFloat(), RandomFloat());
+		a4[i] = Vec4(RandomFloat(), RandomFloat(), RandomFloat(), 1.0f);
+		b4[i] = Vec4(RandomFloat(), RandomFloat(), RandomFloat(), 1.0f);
+		am[i] = RandomTransform();
+		bm[i] = RandomTransform();
+	}
+
+	Benchmark("vec3_add", [&](long long n)
+	{
+		Vec3 sum;
+		for (long long i = 0; i < n; i++)
+			sum += a3[i & Mask] + b3[i & Mask];
+		Escape(&sum);
+	});
+
+	Benchmark("vec3_dot", [&](long long n)
+	{
+		float sum = 0.0f;
+		for (long long i = 0; i < n; i++)
+			sum += Vec3::Dot(a3[i & Mask], b3[i & Mask]);
+		Escape(&sum);
+	});
+
+	Benchmark("vec3_cross", [&](long long n)
+	{
+		Vec3 sum;
+		for (long long i = 0; i < n; i++)
+			sum += Vec3::Cross(a3[i & Mask], b3[i & Mask]);
+		Escape(&sum);
+	});
+
+	Benchmark("vec3_normal", [&](long long n)
+	{
+		Vec3 sum;
+		for (long long i = 0; i < n; i++)
+			sum += a3[i & Mask].Normal();
+		Escape(&sum);
+	});
+
+	Benchmark("vec4_add", [&](long long n)
+	{
+		Vec4 sum;
+		for (long long i = 0; i < n; i++)
+			sum += a4[i & Mask] + b4[i & Mask];
+		Escape(&sum);
+	});
+
+	Benchmark("vec4_dot", [&](long long n)
+	{
+		float sum = 0.0f;
+		for (long long i = 0; i < n; i++)
+			sum += Vec4::Dot(a4[i & Mask], b4[i & Mask]);
+		Escape(&sum);
+	});
+
+	Benchmark("matrix_mul_matrix", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			Matrix m = am[i & Mask] * bm[i & Mask];
+			Escape(&m);
+		}
+	});
+
+	Benchmark("matrix_mul_vec4", [&](long long n)
+	{
+		Vec4 sum;
+		for (long long i = 0; i < n; i++)
+			sum += am[i & Mask] * a4[i & Mask];
+		Escape(&sum);
+	});
+
+	Benchmark("matrix_mul_vec3", [&](long long n)
+	{
+		Vec3 sum;
+		for (long long i = 0; i < n; i++)
+			sum += am[i & Mask] * a3[i & Mask];
+		Escape(&sum);
+	});
+
+	Benchmark("matrix_inverse", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			Matrix m = Matrix::GetInverse(am[i & Mask]);
+			Escape(&m);
+		}
+	});
+
+	Benchmark("matrix_rigid_inverse", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			Matrix m = Matrix::GetRigidInverse(am[i & Mask]);
+			Escape(&m);
+		}
+	});
+
+	Benchmark("matrix_affine_inverse", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			Matrix m = Matrix::GetAffineInverse(am[i & Mask]);
+			Escape(&m);
+		}
+	});
+
+	Benchmark("matrix_rotation_axis", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			Matrix m(Vec3(0.0f, 1.0f, 0.0f), a3[i & Mask].x * 180.0f);
+			Escape(&m);
+		}
+	});
+
+	// The per-frame camera setup in ExampleApp::Run
+	Camera camera;
+	Benchmark("camera_corner_rays", [&](long long n)
+	{
+		Vec3 r00, r10, r01, r11;
+		for (long long i = 0; i < n; i++)
+		{
+			camera.GetCornerRays(r00, r10, r01, r11);
+			Escape(&r00);
+		}
+	});
+}
+
+
+// Camera against a mesh, as in the collision pass of ExampleApp::Run
+static void CollisionBenchmarks()
+{
+	GameObject *sphere = ObjParser::LoadMesh("../resources/models/tris/icosphere.obj");
+	GameObject *monkey = ObjParser::LoadMesh("../resources/models/tris/monkey.obj");
+	if (sphere == nullptr || monkey == nullptr)
+		return;
+
+	sphere->SetTransform(Vec3(0.0f, 0.0f, 0.0f), 0.0f);
+	monkey->SetTransform(Vec3(0.0f, 0.0f, 0.0f), 30.0f);
+
+	Camera camera;
+	CollisionInfo info;
+
+	// Overlapping, GJK finds the overlap and EPA the penetration
+	camera.position = Vec3(0.0f, 0.0f, 0.9f);
+	Benchmark("gjk_epa_camera_sphere", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			bool hit = GJK::GJKIntersect(&camera, sphere, info);
+			Escape(&hit);
+		}
+	});
+
+	Benchmark("gjk_epa_camera_monkey", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			bool hit = GJK::GJKIntersect(&camera, monkey, info);
+			Escape(&hit);
+		}
+	});
+
+	// Separated, GJK exits early
+	camera.position = Vec3(0.0f, 0.0f, 5.0f);
+	Benchmark("gjk_miss_camera_sphere", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			bool hit = GJK::GJKIntersect(&camera, sphere, info);
+			Escape(&hit);
+		}
+	});
+
+	// Per-frame animation of the dynamic objects
+	Matrix step(Vec3(0.0f, 1.0f, 0.0f), 1.0f);
+	Benchmark("gameobject_rotate_monkey", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+			monkey->Rotate(step);
+		Escape(monkey);
+	});
+
+	// Exact bounds from the vertices, what Rotate used to pay every call
+	Benchmark("gameobject_fitaabb_monkey", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+			monkey->FitAABB();
+		Escape(monkey);
+	});
+
+	delete sphere;
+	delete monkey;
+}
+
+
+static void LoadingBenchmarks()
+{
+	Benchmark("objparser_loadmesh_monkey", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			GameObject *obj = ObjParser::LoadMesh("../resources/models/tris/monkey.obj");
+			Escape(obj);
+			delete obj;
+		}
+	});
+
+	Benchmark("glbparser_loadmesh_monkey", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			GameObject *obj = GlbParser::LoadMesh("../resources/models/tris/monkey.glb");
+			Escape(obj);
+			delete obj;
+		}
+	});
+
+	Benchmark("objparser_loadscene", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			std::vector<GameObject*> objects;
+			ObjParser::LoadScene("../resources/models/ray_tracer_scene.obj", objects);
+			Escape(objects.data());
+
+			for (unsigned int j = 0; j < objects.size(); j++)
+				delete objects[j];
+		}
+	});
+
+	// The objects come from GameObjectPool, a freed slot is taken again
+	std::vector<GameObject*> pooled(1024);
+	Benchmark("gameobject_new_delete_1024", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			for (unsigned int j = 0; j < pooled.size(); j++)
+				pooled[j] = new GameObject();
+			Escape(pooled.data());
+
+			for (unsigned int j = 0; j < pooled.size(); j++)
+				delete pooled[j];
+		}
+	});
+
+	// Packing of the dynamic buffer, done every frame in ExampleApp::SendBuffer
+	std::vector<GameObject*> scene;
+	ObjParser::LoadScene("../resources/models/ray_tracer_scene.obj", scene);
+	scene.push_back(ObjParser::LoadMesh("../resources/models/tris/monkey.obj"));
+	scene.push_back(ObjParser::LoadMesh("../resources/models/tris/icosphere.obj"));
+
+	std::vector<float> packed;
+	Benchmark("scenebuffer_pack", [&](long long n)
+	{
+		for (long long i = 0; i < n; i++)
+		{
+			SceneBuffer::Pack(scene, packed);
+			Escape(packed.data());
+		}
+	});
+
+	for (unsigned int i = 0; i < scene.size(); i++)
+		delete scene[i];
+}
+
+
+static void AnimationBenchmarks()
+{
+	// A large animated scene, every object spins and orbits the origin. One
+	// frame is the animation step plus repacking the objects that moved
+	const int Count = 1024;
+	std::vector<GameObject*> objects;
+	Animator animator;
+	for (int i = 0; i < Count; i++)
+	{
+		GameObject *obj = ObjParser::LoadMesh("../resources/models/tris/icosphere_lowres_small.obj");
+		obj->SetTransform(Vec3(RandomFloat() * 50.0f, RandomFloat() * 10.0f, RandomFloat() * 50.0f), 0);
+		animator.AddOrbit(obj, Vec3(0, 0, 0), Vec3(0, 1, 0), 10.0f + RandomFloat() * 40.0f);
+		animator.AddSpin(obj, Vec3(0, 1, 0), 100.0f);
+		objects.push_back(obj);
+	}
+
+	std::vector<float> packed;
+	SceneBuffer::Pack(objects, packed);
+
+	const float dt = 1.0f / 60.0f;
+	Benchmark("animator_update_1024", [&](long long n)
+	{
+		size_t first, last;
+		for (long long i = 0; i < n; i++)
+		{
+			animator.Update(dt);
+			GameObject::UpdateTransforms(objects);
+			SceneBuffer::Update(objects, packed, first, last);
+			Escape(packed.data());
+		}
+	});
+
+	ThreadPool pool;
+	Benchmark("animator_update_1024_pool", [&](long long n)
+	{
+		size_t first, last;
+		for (long long i = 0; i < n; i++)
+		{
+			animator.Update(dt, &pool);
+			GameObject::UpdateTransforms(objects);
+			SceneBuffer::Update(objects, packed, first, last, &pool);
+			Escape(packed.data());
+		}
+	});
+
+	for (unsigned int i = 0; i < objects.size(); i++)
+		delete objects[i];
+}
+
+
+int
+main(int argc, const char** argv)
+{
+	const char *jsonFile = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = (i + 1 < argc);
+
+		if (arg == "--json" && hasValue)
+			jsonFile = argv[++i];
+		else if (arg == "--filter" && hasValue)
+			filter = argv[++i];
+		else if (arg == "--min-time" && hasValue)
+			minTime = atof(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: %s [--json <file>] [--filter <substring>] [--min-time <seconds>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	srand(1);
+	MathBenchmarks();
+	CollisionBenchmarks();
+	LoadingBenchmarks();
+	AnimationBenchmarks();
+
+	if (jsonFile != nullptr && !WriteJSON(jsonFile))
+		return 1;
+
+	return 0;
+}
@@ -72,28 +72,16 @@ public:
 	~EPA();
 
 
-	// Get the furthest point in a given direction
+	// Get the furthest point in a given direction. Walks the object's convex
+	// hull from the corner the last query ended on, the next query is usually
+	// in a similar direction so it is only a few steps away
 	static Vec3 MaxPointAlongDirection(const Vec3 direction, GameObject *go)
 	{
-		unsigned int size = go->values.size();
+		ConvexHull &hull = go->GetHull();
+		if (hull.Empty())
+			return Vec3();
 
-		// Get the point with the largest dot product
-		float max = -INFINITY;
-		Vec3 pos;
-		
-		for (unsigned int i = 6; i < size; i += 3)
-		{
-			Vec3 tmpPos = go->transform * Vec3(go->values[i], go->values[i+1], go->values[i+2]);
-			float dot = Vec3::Dot(tmpPos, direction);
-
-			if (dot > max)
-			{
-				max = dot;
-				pos = tmpPos;
-			}
-		}
-
-		return pos;
+		return hull.Support(go->transform, direction);
 	}
 	static Vec3 MaxPointAlongDirection(const Vec3 direction, Camera *cam)
 	{
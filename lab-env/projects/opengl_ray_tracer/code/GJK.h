@@ -19,42 +19,18 @@ public:
 	~GJK()
 	{}
 
-	// Get the furthest point in a given direction
+	// Get the furthest corner of the OBB in a given direction. With the
+	// direction in model space the corner is picked by the sign of each axis
 	static Vec3 MaxPointAlongDirection(const Vec3 direction, GameObject *go)
 	{
-		// Get OBB
-		Vec3 *obb = new Vec3[8];
-
-		// Back half
-		obb[0] = Vec3(go->values[0], go->values[1], go->values[2]);
-		obb[1] = Vec3(go->values[3], go->values[1], go->values[2]);
-		obb[2] = Vec3(go->values[3], go->values[4], go->values[2]);
-		obb[3] = Vec3(go->values[0], go->values[4], go->values[2]);
-
-		// Front half
-		obb[4] = Vec3(go->values[0], go->values[1], go->values[5]);
-		obb[5] = Vec3(go->values[3], go->values[1], go->values[5]);
-		obb[6] = Vec3(go->values[3], go->values[4], go->values[5]);
-		obb[7] = Vec3(go->values[0], go->values[4], go->values[5]);
-
-
-		// Get the point with the largest dot product
-		float max = -INFINITY;
-		Vec3 pos;
-		for (unsigned int i = 0; i < 8; i++)
-		{
-			Vec3 tmpPos = go->transform * obb[i];
-			float dot = Vec3::Dot(tmpPos, direction);
+		const Matrix &m = go->transform;
+		Vec3 local = m.TransposeRotate(direction);
 
-			if (dot > max)
-			{
-				max = dot;
-				pos = tmpPos;
-			}
-		}
+		Vec3 corner(local.x > 0.0f ? go->localMax.x : go->localMin.x,
+					local.y > 0.0f ? go->localMax.y : go->localMin.y,
+					local.z > 0.0f ? go->localMax.z : go->localMin.z);
 
-		delete[] obb;
-		return pos;
+		return m * corner;
 	}
 
 
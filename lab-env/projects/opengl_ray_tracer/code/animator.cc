@@ -0,0 +1,171 @@
+#include "animator.h"
+#include "threadPool.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+// Animations per pool task
+static const int BatchSize = 64;
+
+
+Animator::Animator()
+{}
+
+Animator::~Animator()
+{}
+
+
+Animator::Animation& Animator::Find(GameObject *go)
+{
+	// Every component of an object goes into the same entry
+	GameObjectPool::Handle handle = go->GetHandle();
+	std::unordered_map<uint32_t, int>::iterator it = this->entries.find(handle.index);
+	if (it != this->entries.end())
+	{
+		// The slot's last object was deleted, start over for the new one
+		Animation &a = this->animations[it->second];
+		if (a.object.generation != handle.generation)
+		{
+			a = Animation();
+			a.object = handle;
+		}
+		return a;
+	}
+
+	this->entries[handle.index] = this->animations.size();
+	this->animations.push_back(Animation());
+	this->animations.back().object = handle;
+	return this->animations.back();
+}
+
+void Animator::AddSpin(GameObject *go, const Vec3 &axis, const float degreesPerSecond)
+{
+	Animation &a = this->Find(go);
+	a.spinAxis = axis;
+	a.spinSpeed = degreesPerSecond;
+	this->stepsValid = false;
+}
+
+void Animator::AddOrbit(GameObject *go, const Vec3 &point, const Vec3 &axis, const float degreesPerSecond)
+{
+	Animation &a = this->Find(go);
+	a.orbitPoint = point;
+	a.orbitAxis = axis;
+	a.orbitSpeed = degreesPerSecond;
+	this->stepsValid = false;
+}
+
+void Animator::AddPath(GameObject *go, const std::vector<Vec3> &points, const float seconds)
+{
+	if (points.empty() || seconds <= 0.0f)
+		return;
+
+	Animation &a = this->Find(go);
+	a.pathFirst = this->pathPoints.size();
+	a.pathCount = points.size();
+	a.pathSeconds = seconds;
+	a.pathTime = 0.0f;
+	this->pathPoints.insert(this->pathPoints.end(), points.begin(), points.end());
+}
+
+void Animator::Clear()
+{
+	this->animations.clear();
+	this->entries.clear();
+	this->pathPoints.clear();
+	this->locals.clear();
+	this->stepsValid = false;
+}
+
+int Animator::Size()const
+{
+	return this->animations.size();
+}
+
+void Animator::Rewind()
+{
+	for (size_t i = 0; i < this->animations.size(); i++)
+		this->animations[i].pathTime = 0.0f;
+}
+
+
+void Animator::Step(const int i, const float dt, const bool newSteps)
+{
+	Animation &a = this->animations[i];
+
+	if (newSteps)
+	{
+		a.orbitStep = Matrix(a.orbitAxis, a.orbitSpeed * dt);
+		a.spinStep = Matrix(a.spinAxis, a.spinSpeed * dt);
+	}
+
+	GameObject *go = GameObjectPool::Get(a.object);
+	if (go == nullptr)
+		return;
+
+	Matrix local = go->localTransform;
+
+	if (a.orbitSpeed != 0.0f)
+		local = GameObject::OrbitMatrix(local, a.orbitPoint, a.orbitStep);
+
+	if (a.spinSpeed != 0.0f)
+		local = GameObject::RotateMatrix(local, a.spinStep);
+
+	if (a.pathCount > 0)
+	{
+		a.pathTime = std::fmod(a.pathTime + dt, a.pathSeconds);
+
+		// Point k to point k+1, the last one goes back to the first
+		float t = a.pathTime / a.pathSeconds * a.pathCount;
+		int k = (int)t;
+		if (k >= a.pathCount)
+			k = a.pathCount - 1;
+
+		const Vec3 &p0 = this->pathPoints[a.pathFirst + k];
+		const Vec3 &p1 = this->pathPoints[a.pathFirst + (k + 1) % a.pathCount];
+		local.SetPosition(p0 + (p1 - p0) * (t - k));
+	}
+
+	this->locals[i] = local;
+}
+
+void Animator::Update(const float dt, ThreadPool *pool)
+{
+	int count = this->animations.size();
+	if (count == 0)
+		return;
+
+	bool newSteps = !this->stepsValid || dt != this->stepDt;
+	this->stepDt = dt;
+	this->stepsValid = true;
+
+	this->locals.resize(count);
+
+	// Each entry only writes its own slot, the objects are left alone until
+	// every new transform is known. A task is a batch of entries, one step
+	// is too small to be worth a trip through the pool's queues
+	if (pool != nullptr && count > BatchSize)
+	{
+		int nrBatches = (count + BatchSize - 1) / BatchSize;
+		pool->ParallelFor(nrBatches, [this, count, dt, newSteps](int batch)
+		{
+			int end = std::min(count, (batch + 1) * BatchSize);
+			for (int i = batch * BatchSize; i < end; i++)
+				this->Step(i, dt, newSteps);
+		});
+	}
+	else
+	{
+		for (int i = 0; i < count; i++)
+			this->Step(i, dt, newSteps);
+	}
+
+	// SetTransform touches the parent's children, so this part is serial
+	for (int i = 0; i < count; i++)
+	{
+		GameObject *go = GameObjectPool::Get(this->animations[i].object);
+		if (go != nullptr)
+			go->SetTransform(this->locals[i]);
+	}
+}
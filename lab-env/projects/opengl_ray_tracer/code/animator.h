@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "gameObject.h"
+#include "mathMatrix.h"
+#include "mathVec3.h"
+
+class ThreadPool;
+
+
+// Spin, orbit and path components of the dynamic objects, kept in one array
+// and evaluated together once per frame. Each object has at most one entry,
+// the orbit is applied first, then the spin, and a path sets the position.
+// Objects are held by handle, deleting one just stops its animation
+class Animator
+{
+public:
+
+	Animator();
+	~Animator();
+
+	// degreesPerSecond around an axis through the object's position
+	void AddSpin(GameObject *go, const Vec3 &axis, const float degreesPerSecond);
+
+	// degreesPerSecond around an axis through point, in the parent's space
+	void AddOrbit(GameObject *go, const Vec3 &point, const Vec3 &axis, const float degreesPerSecond);
+
+	// Go around the loop through the points in seconds, linear between them
+	void AddPath(GameObject *go, const std::vector<Vec3> &points, const float seconds);
+
+	void Clear();
+	int Size()const;
+
+	// Start the paths over, for when the objects are put back at time 0
+	void Rewind();
+
+	// Step every animation by dt. The new local transforms are computed on the
+	// pool when one is given, children get their world transforms from
+	// GameObject::UpdateTransforms afterwards
+	void Update(const float dt, ThreadPool *pool = nullptr);
+
+private:
+
+	struct Animation
+	{
+		GameObjectPool::Handle object;
+
+		Vec3 orbitPoint;
+		Vec3 orbitAxis;
+		float orbitSpeed = 0.0f;
+
+		Vec3 spinAxis;
+		float spinSpeed = 0.0f;
+
+		// Points in pathPoints, none without a path
+		int pathFirst = 0;
+		int pathCount = 0;
+		float pathSeconds = 0.0f;
+		float pathTime = 0.0f;
+
+		// Rotation of one step, made again when the timestep changes
+		Matrix orbitStep;
+		Matrix spinStep;
+	};
+
+	Animation& Find(GameObject *go);
+	void Step(const int i, const float dt, const bool newSteps);
+
+	std::vector<Animation> animations;
+	// Slot index to animation
+	std::unordered_map<uint32_t, int> entries;
+	std::vector<Vec3> pathPoints;
+
+	// New local transforms, applied to the objects after the parallel part
+	std::vector<Matrix> locals;
+
+	// The step rotations are for this timestep, unless an animation was added
+	float stepDt = 0.0f;
+	bool stepsValid = false;
+};
@@ -160,4 +160,26 @@ void Camera::Orbit(const Vec3 &point, const Vec3 &axis, const float speed)
 					);
 
 	//this->hAngle += orbitSpeed*dt;
-}
\ No newline at end of file
+}
+
+void Camera::GetCornerRays(Vec3 &ray00, Vec3 &ray10, Vec3 &ray01, Vec3 &ray11)const
+{
+	// The view is rigid and the projection has a closed form inverse. Only the
+	// rotation of the view is undone so the rays never pass through world
+	// space, where subtracting the camera position cancels precision
+	Matrix rotation = this->view;
+	rotation.SetPosition(0, 0, 0);
+	Matrix invVP = Matrix::GetRigidInverse(rotation) * Matrix::GetProjectionInverse(this->projection);
+
+	Vec4 r00 = invVP * Vec4(-1.25f, -1, 0, 1);
+	Vec4 r10 = invVP * Vec4(1.25f, -1, 0, 1);
+	Vec4 r01 = invVP * Vec4(-1.25f, 1, 0, 1);
+	Vec4 r11 = invVP * Vec4(1.25f, 1, 0, 1);
+
+	// w only depends on the depth, so it is the same for all corners
+	float invW = 1.0f / r00.w;
+	ray00 = Vec3(r00 * invW);
+	ray10 = Vec3(r10 * invW);
+	ray01 = Vec3(r01 * invW);
+	ray11 = Vec3(r11 * invW);
+}
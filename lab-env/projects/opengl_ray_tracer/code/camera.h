@@ -26,4 +26,7 @@ public:
 	void Move(const float dt);
 	void Update(const float dt);
 	void Orbit(const Vec3 &point, const Vec3 &axis, const float speed);
+
+	// Directions from the camera through the corners of the screen
+	void GetCornerRays(Vec3 &ray00, Vec3 &ray10, Vec3 &ray01, Vec3 &ray11)const;
 };
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "cameraPath.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+
+/*
+	File layout, little endian:
+		4x char		"RTCP"
+		1x uint32	version
+		1x float	timestep
+		1x uint32	nrSamples
+
+		nrSamples *
+		{
+			1x float time
+			3x float position
+			1x float hAngle
+			1x float vAngle
+		}
+*/
+static const char PathMagic[4] = { 'R', 'T', 'C', 'P' };
+static const uint32_t PathVersion = 1;
+static const int FloatsPerSample = 6;
+
+
+CameraPath::CameraPath()
+{}
+
+CameraPath::~CameraPath()
+{}
+
+
+void CameraPath::Clear()
+{
+	this->samples.clear();
+}
+
+void CameraPath::Add(const float time, const Vec3 &position, const float hAngle, const float vAngle)
+{
+	CameraSample s;
+	s.time = time;
+	s.position = position;
+	s.hAngle = hAngle;
+	s.vAngle = vAngle;
+
+	this->samples.push_back(s);
+}
+
+int CameraPath::Size()const
+{
+	return this->samples.size();
+}
+
+float CameraPath::Duration()const
+{
+	if (this->samples.empty())
+		return 0.0f;
+
+	return this->samples.back().time - this->samples.front().time;
+}
+
+int CameraPath::NrFrames()const
+{
+	if (this->samples.empty())
+		return 0;
+
+	// Small bias so float rounding doesn't drop the last sample
+	return int(this->Duration() / this->timestep + 0.001f) + 1;
+}
+
+CameraSample CameraPath::Sample(const float time)const
+{
+	if (this->samples.empty())
+		return CameraSample();
+
+	float t = this->samples.front().time + time;
+
+	if (t <= this->samples.front().time)
+		return this->samples.front();
+	if (t >= this->samples.back().time)
+		return this->samples.back();
+
+	// Binary search for the first sample after t
+	unsigned int lo = 0;
+	unsigned int hi = this->samples.size() - 1;
+	while (hi - lo > 1)
+	{
+		unsigned int mid = (lo + hi) / 2;
+		if (this->samples[mid].time <= t)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	const CameraSample &a = this->samples[lo];
+	const CameraSample &b = this->samples[hi];
+
+	float span = b.time - a.time;
+	float f = (span > 0.0f) ? (t - a.time) / span : 0.0f;
+
+	CameraSample s;
+	s.time = t;
+	s.position = a.position + (b.position - a.position) * f;
+	s.hAngle = a.hAngle + (b.hAngle - a.hAngle) * f;
+	s.vAngle = a.vAngle + (b.vAngle - a.vAngle) * f;
+
+	return s;
+}
+
+bool CameraPath::Save(const char *filename)const
+{
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not write camera path %s\n", filename);
+		return false;
+	}
+
+	uint32_t nrSamples = this->samples.size();
+	fwrite(PathMagic, 1, sizeof(PathMagic), file);
+	fwrite(&PathVersion, sizeof(PathVersion), 1, file);
+	fwrite(&this->timestep, sizeof(float), 1, file);
+	fwrite(&nrSamples, sizeof(nrSamples), 1, file);
+
+	for (uint32_t i = 0; i < nrSamples; i++)
+	{
+		const CameraSample &s = this->samples[i];
+		float values[FloatsPerSample] =
+		{
+			s.time,
+			s.position.x, s.position.y, s.position.z,
+			s.hAngle,
+			s.vAngle
+		};
+		fwrite(values, sizeof(float), FloatsPerSample, file);
+	}
+
+	bool ok = !ferror(file);
+	ok = (fclose(file) == 0) && ok;
+	if (!ok)
+	{
+		fprintf(stderr, "Could not write camera path %s\n", filename);
+		return false;
+	}
+
+	fprintf(stderr, "Wrote %u camera samples to %s\n", nrSamples, filename);
+	return true;
+}
+
+bool CameraPath::Load(const char *filename)
+{
+	FILE *file = fopen(filename, "rb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not read camera path %s\n", filename);
+		return false;
+	}
+
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t nrSamples = 0;
+	float timestep = 0.0f;
+
+	bool valid =
+		fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+		memcmp(magic, PathMagic, sizeof(magic)) == 0 &&
+		fread(&version, sizeof(version), 1, file) == 1 &&
+		version == PathVersion &&
+		fread(&timestep, sizeof(timestep), 1, file) == 1 &&
+		timestep > 0.0f &&
+		fread(&nrSamples, sizeof(nrSamples), 1, file) == 1;
+
+	if (!valid)
+	{
+		fprintf(stderr, "Invalid camera path %s\n", filename);
+		fclose(file);
+		return false;
+	}
+
+	// The samples have to fill the rest of the file exactly, which also
+	// keeps a bad count from allocating more than the file holds
+	size_t nrValues = size_t(nrSamples) * FloatsPerSample;
+	long dataStart = ftell(file);
+	bool sized =
+		dataStart >= 0 &&
+		fseek(file, 0, SEEK_END) == 0;
+	long fileEnd = sized ? ftell(file) : -1;
+	sized = sized && fileEnd >= dataStart &&
+		size_t(fileEnd - dataStart) == nrValues * sizeof(float) &&
+		fseek(file, dataStart, SEEK_SET) == 0;
+
+	if (!sized)
+	{
+		fprintf(stderr, "Camera path %s has the wrong size for %u samples\n", filename, nrSamples);
+		fclose(file);
+		return false;
+	}
+
+	std::vector<float> values(nrValues);
+	if (fread(values.data(), sizeof(float), values.size(), file) != values.size())
+	{
+		fprintf(stderr, "Camera path %s is truncated\n", filename);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+
+	this->timestep = timestep;
+	this->samples.clear();
+	this->samples.reserve(nrSamples);
+	for (uint32_t i = 0; i < nrSamples; i++)
+	{
+		const float *v = &values[size_t(i) * FloatsPerSample];
+		this->Add(v[0], Vec3(v[1], v[2], v[3]), v[4], v[5]);
+	}
+
+	return true;
+}
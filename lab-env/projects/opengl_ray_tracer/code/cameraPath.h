@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "mathVec3.h"
+
+
+struct CameraSample
+{
+	// Time of the dynamic objects when the pose was recorded
+	float time = 0.0f;
+
+	Vec3 position;
+	float hAngle = 0.0f;
+	float vAngle = 0.0f;
+};
+
+
+// Recorded camera poses that are played back with a fixed timestep, so the
+// same frames are rendered on every machine
+class CameraPath
+{
+public:
+
+	float timestep = 1.0f / 60.0f;
+	std::vector<CameraSample> samples;
+
+
+	CameraPath();
+	~CameraPath();
+
+	void Clear();
+	void Add(const float time, const Vec3 &position, const float hAngle, const float vAngle);
+
+	int Size()const;
+	float Duration()const;
+
+	// Number of fixed timesteps needed to play the whole path
+	int NrFrames()const;
+
+	// Pose at a time since the first sample, linear interpolation between samples
+	CameraSample Sample(const float time)const;
+
+	bool Save(const char *filename)const;
+	bool Load(const char *filename);
+};
@@ -34,7 +34,7 @@ void ComputeShader::Draw(int groupSizeX, int groupSizeY)
 	glDispatchCompute((GLuint)groupSizeX, (GLuint)groupSizeY, 1);
 
 	// Make sure writing to image has finnished before moving on
-	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
 }
 
 
@@ -113,6 +113,10 @@ void ComputeShader::GetUniformHandles()
 	uniformLocations.insert(std::pair<std::string, GLuint>("ray01", handle));
 	handle = glGetUniformLocation(program, "ray11");
 	uniformLocations.insert(std::pair<std::string, GLuint>("ray11", handle));
+
+	// Debug output
+	handle = glGetUniformLocation(program, "debugMode");
+	uniformLocations.insert(std::pair<std::string, GLuint>("debugMode", handle));
 }
 
 
@@ -0,0 +1,430 @@
+#include "convexHull.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+// The hull is built in double so the plane tests agree with each other
+struct HullPoint
+{
+	double x, y, z;
+};
+
+struct HullFace
+{
+	int v[3];
+	HullPoint normal;
+	double offset;
+	bool removed;
+};
+
+
+static HullPoint Sub(const HullPoint &a, const HullPoint &b)
+{
+	HullPoint p = { a.x - b.x, a.y - b.y, a.z - b.z };
+	return p;
+}
+
+static HullPoint Cross(const HullPoint &a, const HullPoint &b)
+{
+	HullPoint p = { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	return p;
+}
+
+static double Dot(const HullPoint &a, const HullPoint &b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static double Axis(const HullPoint &a, const int axis)
+{
+	return axis == 0 ? a.x : (axis == 1 ? a.y : a.z);
+}
+
+static HullPoint Normalized(const HullPoint &a)
+{
+	double length = std::sqrt(Dot(a, a));
+	if (length == 0.0)
+		return a;
+
+	HullPoint p = { a.x / length, a.y / length, a.z / length };
+	return p;
+}
+
+static HullFace MakeFace(const std::vector<HullPoint> &p, const int a, const int b, const int c)
+{
+	HullFace f;
+	f.v[0] = a;
+	f.v[1] = b;
+	f.v[2] = c;
+	f.normal = Normalized(Cross(Sub(p[b], p[a]), Sub(p[c], p[a])));
+	f.offset = Dot(f.normal, p[a]);
+	f.removed = false;
+	return f;
+}
+
+
+ConvexHull::ConvexHull()
+{}
+
+ConvexHull::~ConvexHull()
+{}
+
+
+// Corners from point numbers, edges as pairs of corner numbers in both directions
+static void SetCorners(ConvexHull &hull, const std::vector<HullPoint> &p,
+					   const std::vector<int> &corners, const std::vector<int> &edges)
+{
+	int nrCorners = corners.size();
+	hull.points.resize(nrCorners);
+	for (int i = 0; i < nrCorners; i++)
+		hull.points[i] = Vec3((float)p[corners[i]].x, (float)p[corners[i]].y, (float)p[corners[i]].z);
+
+	hull.firstNeighbour.assign(nrCorners + 1, 0);
+	for (size_t i = 0; i < edges.size(); i += 2)
+		hull.firstNeighbour[edges[i] + 1]++;
+	for (int i = 0; i < nrCorners; i++)
+		hull.firstNeighbour[i + 1] += hull.firstNeighbour[i];
+
+	std::vector<int> next(hull.firstNeighbour.begin(), hull.firstNeighbour.end() - 1);
+	hull.neighbours.resize(edges.size() / 2);
+	for (size_t i = 0; i < edges.size(); i += 2)
+		hull.neighbours[next[edges[i]]++] = edges[i + 1];
+}
+
+struct Point2
+{
+	double x, y;
+	int index;
+
+	bool operator<(const Point2 &o)const
+	{
+		return x < o.x || (x == o.x && y < o.y);
+	}
+};
+
+// Twice the signed area of abc, positive when c is to the left of ab
+static double Turn(const Point2 &a, const Point2 &b, const Point2 &c)
+{
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// All points on a plane through p[a] with the normal, the hull is a polygon
+static void BuildPolygon(ConvexHull &hull, const std::vector<HullPoint> &p, const int a, const int b,
+						 const HullPoint &normal, const double eps)
+{
+	HullPoint u = Normalized(Sub(p[b], p[a]));
+	HullPoint v = Cross(normal, u);
+
+	std::vector<Point2> points(p.size());
+	for (size_t i = 0; i < p.size(); i++)
+	{
+		HullPoint d = Sub(p[i], p[a]);
+		points[i].x = Dot(d, u);
+		points[i].y = Dot(d, v);
+		points[i].index = i;
+	}
+	std::sort(points.begin(), points.end());
+
+	// Andrew's monotone chain, lower half then upper half. Points on an edge
+	// are left out
+	int n = points.size();
+	std::vector<Point2> ring(2 * n);
+	int k = 0;
+	for (int i = 0; i < n; i++)
+	{
+		while (k >= 2 && Turn(ring[k - 2], ring[k - 1], points[i]) <= eps)
+			k--;
+		ring[k++] = points[i];
+	}
+	for (int i = n - 2, lower = k + 1; i >= 0; i--)
+	{
+		while (k >= lower && Turn(ring[k - 2], ring[k - 1], points[i]) <= eps)
+			k--;
+		ring[k++] = points[i];
+	}
+	k--;
+
+	// Just the two ends if the points turn out to be on a line after all
+	std::vector<int> corners;
+	if (k >= 3)
+	{
+		for (int i = 0; i < k; i++)
+			corners.push_back(ring[i].index);
+	}
+	else
+	{
+		corners.push_back(points.front().index);
+		corners.push_back(points.back().index);
+	}
+	int nrCorners = corners.size();
+
+	std::vector<int> edges;
+	for (int i = 0; i < nrCorners; i++)
+	{
+		int j = (i + 1) % nrCorners;
+		if (nrCorners == 2 && i == 1)
+			break;
+
+		edges.push_back(i);
+		edges.push_back(j);
+		edges.push_back(j);
+		edges.push_back(i);
+	}
+
+	SetCorners(hull, p, corners, edges);
+}
+
+
+void ConvexHull::Build(const float *xs, const float *ys, const float *zs, const int count)
+{
+	this->Clear();
+	if (count <= 0)
+		return;
+
+	std::vector<HullPoint> p(count);
+	HullPoint min = { xs[0], ys[0], zs[0] };
+	HullPoint max = min;
+	for (int i = 0; i < count; i++)
+	{
+		p[i].x = xs[i];
+		p[i].y = ys[i];
+		p[i].z = zs[i];
+
+		min.x = std::min(min.x, p[i].x);
+		min.y = std::min(min.y, p[i].y);
+		min.z = std::min(min.z, p[i].z);
+		max.x = std::max(max.x, p[i].x);
+		max.y = std::max(max.y, p[i].y);
+		max.z = std::max(max.z, p[i].z);
+	}
+
+	// Points closer than this to a face count as on it
+	HullPoint extent = Sub(max, min);
+	double size = std::max(extent.x, std::max(extent.y, extent.z));
+	double eps = size * 1e-5;
+
+	if (size == 0.0)
+	{
+		SetCorners(*this, p, std::vector<int>(1, 0), std::vector<int>());
+		return;
+	}
+
+
+	// Start from a tetrahedron of points far apart: the extremes along the
+	// longest axis, the point furthest from that line and then from that plane
+	int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+	int i0 = 0;
+	int i1 = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (Axis(p[i], axis) < Axis(p[i0], axis)) i0 = i;
+		if (Axis(p[i], axis) > Axis(p[i1], axis)) i1 = i;
+	}
+
+	HullPoint line = Normalized(Sub(p[i1], p[i0]));
+	int i2 = i0;
+	double best = 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		HullPoint c = Cross(Sub(p[i], p[i0]), line);
+		double distance = std::sqrt(Dot(c, c));
+		if (distance > best)
+		{
+			best = distance;
+			i2 = i;
+		}
+	}
+
+	// On a line, the ends are the hull
+	if (best <= eps)
+	{
+		std::vector<int> corners;
+		corners.push_back(i0);
+		corners.push_back(i1);
+		int edges[] = { 0, 1, 1, 0 };
+		SetCorners(*this, p, corners, std::vector<int>(edges, edges + 4));
+		return;
+	}
+
+	HullPoint planeNormal = Normalized(Cross(Sub(p[i1], p[i0]), Sub(p[i2], p[i0])));
+	int i3 = i0;
+	best = 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		double distance = std::fabs(Dot(planeNormal, Sub(p[i], p[i0])));
+		if (distance > best)
+		{
+			best = distance;
+			i3 = i;
+		}
+	}
+
+	if (best <= eps)
+	{
+		BuildPolygon(*this, p, i0, i1, planeNormal, eps * size);
+		return;
+	}
+
+
+	// Turn the first faces outward, away from the middle of the tetrahedron
+	HullPoint center = { (p[i0].x + p[i1].x + p[i2].x + p[i3].x) * 0.25,
+						 (p[i0].y + p[i1].y + p[i2].y + p[i3].y) * 0.25,
+						 (p[i0].z + p[i1].z + p[i2].z + p[i3].z) * 0.25 };
+
+	std::vector<HullFace> faces;
+	int tetrahedron[4][3] = { { i0, i1, i2 }, { i0, i1, i3 }, { i1, i2, i3 }, { i2, i0, i3 } };
+	for (int i = 0; i < 4; i++)
+	{
+		HullFace f = MakeFace(p, tetrahedron[i][0], tetrahedron[i][1], tetrahedron[i][2]);
+		if (Dot(f.normal, center) - f.offset > 0.0)
+			f = MakeFace(p, tetrahedron[i][0], tetrahedron[i][2], tetrahedron[i][1]);
+		faces.push_back(f);
+	}
+
+
+	// Add the points one at a time. The faces a point is outside of are
+	// replaced by a fan from the point to the edge around them
+	std::vector<int> visible;
+	std::vector<int> horizon;
+	int nrRemoved = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (i == i0 || i == i1 || i == i2 || i == i3)
+			continue;
+
+		visible.clear();
+		for (size_t f = 0; f < faces.size(); f++)
+		{
+			if (!faces[f].removed && Dot(faces[f].normal, p[i]) - faces[f].offset > eps)
+				visible.push_back(f);
+		}
+
+		if (visible.empty())
+			continue;
+
+		// An edge is on the horizon when the face on its other side stays
+		horizon.clear();
+		for (size_t j = 0; j < visible.size(); j++)
+		{
+			const int *v = faces[visible[j]].v;
+			for (int e = 0; e < 3; e++)
+			{
+				int a = v[e];
+				int b = v[(e + 1) % 3];
+
+				bool shared = false;
+				for (size_t k = 0; k < visible.size() && !shared; k++)
+				{
+					const int *w = faces[visible[k]].v;
+					shared = (w[0] == b && w[1] == a) || (w[1] == b && w[2] == a) || (w[2] == b && w[0] == a);
+				}
+
+				if (!shared)
+				{
+					horizon.push_back(a);
+					horizon.push_back(b);
+				}
+			}
+		}
+
+		for (size_t j = 0; j < visible.size(); j++)
+			faces[visible[j]].removed = true;
+		nrRemoved += visible.size();
+
+		for (size_t j = 0; j < horizon.size(); j += 2)
+			faces.push_back(MakeFace(p, horizon[j], horizon[j + 1], i));
+
+		// Drop the removed faces once they are the majority
+		if (nrRemoved * 2 > (int)faces.size())
+		{
+			faces.erase(std::remove_if(faces.begin(), faces.end(), [](const HullFace &f) { return f.removed; }), faces.end());
+			nrRemoved = 0;
+		}
+	}
+
+
+	// Number the corners and connect them along the face edges. Every edge is
+	// in two faces, once in each direction
+	std::vector<int> cornerOf(count, -1);
+	std::vector<int> corners;
+	std::vector<int> edges;
+	for (size_t f = 0; f < faces.size(); f++)
+	{
+		if (faces[f].removed)
+			continue;
+
+		for (int e = 0; e < 3; e++)
+		{
+			int v = faces[f].v[e];
+			if (cornerOf[v] < 0)
+			{
+				cornerOf[v] = corners.size();
+				corners.push_back(v);
+			}
+		}
+	}
+
+	for (size_t f = 0; f < faces.size(); f++)
+	{
+		if (faces[f].removed)
+			continue;
+
+		for (int e = 0; e < 3; e++)
+		{
+			edges.push_back(cornerOf[faces[f].v[e]]);
+			edges.push_back(cornerOf[faces[f].v[(e + 1) % 3]]);
+		}
+	}
+
+	SetCorners(*this, p, corners, edges);
+}
+
+void ConvexHull::Clear()
+{
+	this->points.clear();
+	this->firstNeighbour.clear();
+	this->neighbours.clear();
+	this->start = 0;
+}
+
+bool ConvexHull::Empty()const
+{
+	return this->points.empty();
+}
+
+
+int ConvexHull::Support(const Vec3 &direction, int &start)const
+{
+	int corner = (start >= 0 && start < (int)this->points.size()) ? start : 0;
+	float best = Vec3::Dot(this->points[corner], direction);
+
+	// Go to the highest neighbour until none is higher
+	while (true)
+	{
+		int next = corner;
+		for (int i = this->firstNeighbour[corner]; i < this->firstNeighbour[corner + 1]; i++)
+		{
+			int n = this->neighbours[i];
+			float dot = Vec3::Dot(this->points[n], direction);
+			if (dot > best)
+			{
+				best = dot;
+				next = n;
+			}
+		}
+
+		if (next == corner)
+			break;
+		corner = next;
+	}
+
+	start = corner;
+	return corner;
+}
+
+Vec3 ConvexHull::Support(const Matrix &transform, const Vec3 &direction)
+{
+	Vec3 local = transform.TransposeRotate(direction);
+	return transform * this->points[this->Support(local, this->start)];
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include "mathMatrix.h"
+#include "mathVec3.h"
+
+
+// Corners of the convex hull of a point set and the edges between them. The
+// furthest point in a direction is found by walking the edges uphill from
+// the last one found, on a convex hull the first corner with no higher
+// neighbour is the highest. Flat and straight point sets get a polygon or a
+// line, which works the same way
+class ConvexHull
+{
+public:
+
+	// Hull corners, and the corners that share an edge with corner i are
+	// neighbours[firstNeighbour[i]] up to neighbours[firstNeighbour[i + 1]]
+	std::vector<Vec3> points;
+	std::vector<int> firstNeighbour;
+	std::vector<int> neighbours;
+
+
+	ConvexHull();
+	~ConvexHull();
+
+	// From model space points, one array per axis
+	void Build(const float *xs, const float *ys, const float *zs, const int count);
+	void Clear();
+	bool Empty()const;
+
+	// Corner furthest along direction, starting from and updating start
+	int Support(const Vec3 &direction, int &start)const;
+
+	// Furthest point of the transformed hull along a world direction. The
+	// direction is moved into model space instead of moving the corners, and
+	// the walk starts where the last call ended
+	Vec3 Support(const Matrix &transform, const Vec3 &direction);
+
+private:
+
+	int start = 0;
+};
@@ -0,0 +1,340 @@
+#include "cpuTracer.h"
+#include "sceneBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+
+// Same constants as rayTracer.glsl
+static const float MaxSceneBounds = 1000.0f;
+static const float Epsilon = 0.00001f;
+static constexpr Vec3 Light = Vec3(-0.8f, 2.0f, -0.4f);
+
+
+static bool IsSame(const float point, const float value)
+{
+	return (point < value + Epsilon && point > value - Epsilon);
+}
+
+static Vec3 LoadVec3(const float *f)
+{
+	return Vec3(f[0], f[1], f[2]);
+}
+
+
+
+CpuTracer::CpuTracer()
+{}
+
+CpuTracer::~CpuTracer()
+{}
+
+
+void CpuTracer::SetScene(const float *staticBuffer, const float *dynamicBuffer)
+{
+	this->objects.clear();
+	this->triangles.Clear();
+	this->boxes.Clear();
+	this->AddObjects(staticBuffer);
+	this->AddObjects(dynamicBuffer);
+	this->boxes.Pad();
+}
+
+void CpuTracer::AddObjects(const float *buffer)
+{
+	int nrObjects = int(buffer[0] + 0.5f);
+	int objStart = 1 + nrObjects;
+
+	for (int i = 0; i < nrObjects; i++)
+	{
+		int thisNrValues = int(buffer[1+i] + 0.5f);
+		const float *header = buffer + objStart;
+
+		Object obj;
+		obj.nrVerts = int(header[0] + 0.5f);
+		obj.isPortal = (header[1] > 0.5f);
+		obj.exitPortalPosition = LoadVec3(header + 2);
+		obj.exitPortalNormal = LoadVec3(header + 5);
+		obj.color = LoadVec3(header + 8);
+		this->boxes.Add(LoadVec3(header + 11), LoadVec3(header + 14));
+
+		// Same vertex order as the shader, c a b (d)
+		int nrPositions = int(header[17] + 0.5f);
+		const float *positions = header + SceneBuffer::ObjectHeaderSize;
+		const float *indices = positions + nrPositions * 3;
+		int nrIndices = thisNrValues - SceneBuffer::ObjectHeaderSize - nrPositions * 3;
+		int stride = (obj.nrVerts == 3) ? 3 : 4;
+
+		obj.firstTriangle = this->triangles.Size();
+		for (int j = 0; j + stride <= nrIndices; j += stride)
+		{
+			Vec3 c = LoadVec3(positions + int(indices[j] + 0.5f) * 3);
+			Vec3 a = LoadVec3(positions + int(indices[j + 1] + 0.5f) * 3);
+			Vec3 b = LoadVec3(positions + int(indices[j + 2] + 0.5f) * 3);
+			this->triangles.Add(a, b - a, c - a);
+
+			if (obj.nrVerts != 3)
+			{
+				Vec3 d = LoadVec3(positions + int(indices[j + 3] + 0.5f) * 3);
+				this->triangles.Add(d, c - d, b - d);
+			}
+		}
+		this->triangles.Pad();
+		obj.nrTriangles = this->triangles.Size() - obj.firstTriangle;
+
+		this->objects.push_back(obj);
+
+		objStart += thisNrValues;
+	}
+}
+
+
+void CpuTracer::Render(const int width, const int height, float *rgb, ThreadPool &pool)
+{
+	int tilesX = (width + TileSize - 1) / TileSize;
+	int tilesY = (height + TileSize - 1) / TileSize;
+
+	Stats total;
+	std::mutex statsMutex;
+
+	pool.ParallelFor(tilesX * tilesY, [&](int tile)
+	{
+		int x0 = (tile % tilesX) * TileSize;
+		int y0 = (tile / tilesX) * TileSize;
+		int x1 = std::min(x0 + TileSize, width);
+		int y1 = std::min(y0 + TileSize, height);
+
+		Stats counters;
+		for (int y = y0; y < y1; y++)
+		{
+			for (int x = x0; x < x1; x++)
+			{
+				Vec3 color = this->TracePixel(x, y, width, height, counters);
+
+				float *out = rgb + 3 * (y * width + x);
+				out[0] = color.x;
+				out[1] = color.y;
+				out[2] = color.z;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		total.primaryRays += counters.primaryRays;
+		total.portalRays += counters.portalRays;
+		total.shadowRays += counters.shadowRays;
+	});
+
+	this->stats = total;
+}
+
+Vec3 CpuTracer::TracePixel(const int x, const int y, const int width, const int height, Stats &counters)const
+{
+	float px = float(x) / width;
+	float py = float(y) / height;
+
+	// mix(mix(ray00, ray01, py), mix(ray10, ray11, py), px)
+	Vec3 left = this->ray00 + (this->ray01 - this->ray00) * py;
+	Vec3 right = this->ray10 + (this->ray11 - this->ray10) * py;
+
+	Ray ray;
+	ray.origin = this->eye;
+	ray.dir = left + (right - left) * px;
+
+	counters.primaryRays++;
+	return this->Trace(ray, counters);
+}
+
+
+bool CpuTracer::IntersectObject(const Ray &ray, const Object &obj, HitInfo &info)const
+{
+	float t, u, v;
+	int hit = SimdKernel::Closest(this->triangles, obj.firstTriangle, obj.nrTriangles,
+									  ray.origin, ray.dir, MaxSceneBounds, t, u, v);
+	if (hit < 0)
+		return false;
+
+	// Top-left and bottom-right triangle of a portal
+	int local = hit - obj.firstTriangle;
+	info.corner = (obj.nrVerts == 3 && local < 2) ? local + 1 : 0;
+
+	// Dark edges, triangle meshes also get the diagonal
+	if (u < 0.01f || v < 0.01f || (obj.nrVerts == 3 && u + v > 0.99f))
+		info.color = Vec3(0.0f, 0.0f, 0.0f);
+	else
+		info.color = obj.color;
+
+	const TriangleSoA &tris = this->triangles;
+	info.normal = Vec3::Cross(Vec3(tris.abx[hit], tris.aby[hit], tris.abz[hit]),
+							  Vec3(tris.acx[hit], tris.acy[hit], tris.acz[hit]));
+	info.u = u;
+	info.v = v;
+	info.isPortal = obj.isPortal;
+	info.exitPortalPosition = obj.exitPortalPosition;
+	info.exitPortalNormal = obj.exitPortalNormal;
+	info.distance = t;
+
+	return true;
+}
+
+bool CpuTracer::IntersectScene(const Ray &ray, HitInfo &info)const
+{
+	bool intersectSomething = false;
+	float closestAABBFar = MaxSceneBounds;
+
+	// Background color
+	float dirDotY = ray.dir.y;
+	float height = std::sin(dirDotY);
+	if (dirDotY > -0.1f)
+		info.color = Vec3(0.0f, 0.5f, 1.0f) * 2 * (height + 0.11f);
+	else
+		info.color = Vec3(0.3f, 0.4f, 0.3f) * 2 * (-height - 0.08f);
+
+	info.distance = MaxSceneBounds;
+	info.isPortal = false;
+
+	Vec3 invDir(1.0f / ray.dir.x, 1.0f / ray.dir.y, 1.0f / ray.dir.z);
+	float tNear[BoxSoA::Width], tFar[BoxSoA::Width];
+	int nrObjects = this->objects.size();
+
+	for (int first = 0; first < nrObjects; first += BoxSoA::Width)
+	{
+		SimdKernel::Boxes(this->boxes, first, ray.origin, invDir, tNear, tFar);
+
+		// Objects in order, the culling depends on the closest hit so far
+		int last = std::min(first + BoxSoA::Width, nrObjects);
+		for (int i = first; i < last; i++)
+		{
+			int lane = i - first;
+			if (tFar[lane] > 0.0f && tNear[lane] <= tFar[lane] && tNear[lane] < closestAABBFar)
+			{
+				// Only the closest hit is kept, the shader can leave portal
+				// fields from a farther object in its HitInfo
+				HitInfo objInfo;
+				if (this->IntersectObject(ray, this->objects[i], objInfo) && objInfo.distance < info.distance)
+				{
+					info = objInfo;
+					closestAABBFar = tFar[lane];
+					intersectSomething = true;
+				}
+			}
+		}
+	}
+
+	return intersectSomething;
+}
+
+bool CpuTracer::ShadowIntersectScene(const Ray &ray)const
+{
+	Vec3 invDir(1.0f / ray.dir.x, 1.0f / ray.dir.y, 1.0f / ray.dir.z);
+	float tNear[BoxSoA::Width], tFar[BoxSoA::Width];
+	int nrObjects = this->objects.size();
+
+	for (int first = 0; first < nrObjects; first += BoxSoA::Width)
+	{
+		SimdKernel::Boxes(this->boxes, first, ray.origin, invDir, tNear, tFar);
+
+		int last = std::min(first + BoxSoA::Width, nrObjects);
+		for (int i = first; i < last; i++)
+		{
+			const Object &obj = this->objects[i];
+			int lane = i - first;
+
+			// Portals don't block light
+			if (!obj.isPortal && tNear[lane] <= tFar[lane] &&
+				SimdKernel::Any(this->triangles, obj.firstTriangle, obj.nrTriangles, ray.origin, ray.dir))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+CpuTracer::Ray CpuTracer::GenerateNewRay(const HitInfo &info, const Vec3 &rayDir)const
+{
+	Ray r;
+
+	const Vec3 &en = info.normal;
+	const Vec3 &n = info.exitPortalNormal;
+	const Vec3 &p = info.exitPortalPosition;
+
+	// Barycentric coordinates
+	float u = info.u;
+	float v = info.v;
+	float w = 1 - u - v;
+
+	// TR and BL corners of the exit portal
+	Vec3 b(p.x - n.z, p.y + 1.0f, p.z - n.x);
+	Vec3 c(p.x + n.z, p.y - 1.0f, p.z + n.x);
+
+	// Top-left triangle
+	if (info.corner == 1)
+	{
+		Vec3 a(p.x + n.z, p.y + 1.0f, p.z + n.x);
+		r.origin = u*a + v*c + w*b;
+	}
+
+	// Bottom-right triangle
+	else if (info.corner == 2)
+	{
+		Vec3 d(p.x - n.z, p.y - 1.0f, p.z - n.x);
+		r.origin = u*b + v*c + w*d;
+	}
+
+	// If normal is along x-axis, flip z coord
+	if (n.x < -0.5f || n.x > 0.5f)
+		r.origin.z = p.z + (p.z - r.origin.z);
+
+
+	// Normals are opposite, no need to rotate the ray
+	if (en.x * n.x < -0.5f || en.z * n.z < -0.5f)
+		r.dir = rayDir;
+
+	// Normals are rotated 90 degrees
+	else if (en.x * n.z < -0.5f || en.z * n.x > 0.5f)
+		r.dir = Vec3(-rayDir.z, rayDir.y, rayDir.x);
+
+	// Normals are the same, mirror the new ray
+	else if (IsSame(en.x, n.x) || IsSame(en.z, n.z))
+		r.dir = Vec3(-rayDir.x, rayDir.y, -rayDir.z);
+
+	// Else the normals are rotated 270 degrees
+	else
+		r.dir = Vec3(rayDir.z, rayDir.y, -rayDir.x);
+
+	return r;
+}
+
+Vec3 CpuTracer::Trace(Ray ray, Stats &counters)const
+{
+	HitInfo info;
+	int portalDepth = 0;
+
+	bool hitSomething = this->IntersectScene(ray, info);
+
+	// Keep shooting rays until something that isn't a portal is hit
+	while (hitSomething && info.isPortal && portalDepth <= MaxPortalDepth)
+	{
+		ray = this->GenerateNewRay(info, ray.dir);
+		hitSomething = this->IntersectScene(ray, info);
+
+		portalDepth++;
+		counters.portalRays++;
+	}
+
+	Vec3 color = info.color;
+
+	// Basic no-portal shadows
+	if (hitSomething)
+	{
+		Ray shadowRay;
+		shadowRay.origin = ray.origin + ray.dir * info.distance + info.normal * Epsilon;
+		shadowRay.dir = Light.Normal();
+
+		counters.shadowRays++;
+		if (this->ShadowIntersectScene(shadowRay))
+			color *= 0.4f;
+	}
+
+	return color;
+}
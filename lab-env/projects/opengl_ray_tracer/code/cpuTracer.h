@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+
+#include "mathVec3.h"
+#include "threadPool.h"
+#include "simdKernels.h"
+
+
+// C++ version of rayTracer.glsl. Reads the same buffers as the compute shader
+// (see SceneBuffer) so it can render without a GPU and serve as a reference
+// when the shader is changed
+class CpuTracer
+{
+public:
+
+	static const int TileSize = 16;
+	static const int MaxPortalDepth = 5;
+
+	// Rays traced by the last Render call
+	struct Stats
+	{
+		unsigned long long primaryRays = 0;
+		unsigned long long portalRays = 0;
+		unsigned long long shadowRays = 0;
+	};
+
+
+	// Same camera uniforms as the compute shader
+	Vec3 eye;
+	Vec3 ray00;
+	Vec3 ray10;
+	Vec3 ray01;
+	Vec3 ray11;
+
+	Stats stats;
+
+
+	CpuTracer();
+	~CpuTracer();
+
+	// Read the object headers of both buffers, the buffers must stay alive while rendering
+	void SetScene(const float *staticBuffer, const float *dynamicBuffer);
+
+	// RGB floats, rows from the bottom up like the compute shader's texture
+	void Render(const int width, const int height, float *rgb, ThreadPool &pool);
+
+	// Color of a single pixel
+	Vec3 TracePixel(const int x, const int y, const int width, const int height, Stats &counters)const;
+
+private:
+
+	struct Ray
+	{
+		Vec3 origin;
+		Vec3 dir;
+	};
+
+	struct Object
+	{
+		int firstTriangle;
+		int nrTriangles;
+		int nrVerts;
+		bool isPortal;
+		Vec3 exitPortalPosition;
+		Vec3 exitPortalNormal;
+		Vec3 color;
+	};
+
+	struct HitInfo
+	{
+		Vec3 color;
+		Vec3 normal;
+		float distance = 0.0f;
+
+		bool isPortal = false;
+		float u = 0.0f;
+		float v = 0.0f;
+		int corner = 0;
+		Vec3 exitPortalPosition;
+		Vec3 exitPortalNormal;
+	};
+
+	void AddObjects(const float *buffer);
+
+	bool IntersectObject(const Ray &ray, const Object &obj, HitInfo &info)const;
+	bool IntersectScene(const Ray &ray, HitInfo &info)const;
+	bool ShadowIntersectScene(const Ray &ray)const;
+	Ray GenerateNewRay(const HitInfo &info, const Vec3 &rayDir)const;
+	Vec3 Trace(Ray ray, Stats &counters)const;
+
+	std::vector<Object> objects;
+
+	// Triangles of all objects, quads are split in two
+	TriangleSoA triangles;
+
+	// AABB of every object, same order as objects
+	BoxSoA boxes;
+};
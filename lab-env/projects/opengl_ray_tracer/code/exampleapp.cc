@@ -5,6 +5,7 @@
 #include "config.h"
 #include "exampleapp.h"
 #include "imgui.h"
+#include "core/profiler.h"
 
 #ifndef GL_INCLUDED
 #define GL_INCLUDED
@@ -24,7 +25,11 @@ namespace Example
 */
 ExampleApp::ExampleApp()
 {
-	// empty
+	for (int i = 0; i < NrRecentGpuTimes; i++)
+	{
+		this->recentGpuFrames[i] = -1;
+		this->recentGpuTimes[i] = 0.0f;
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -32,10 +37,102 @@ ExampleApp::ExampleApp()
 */
 ExampleApp::~ExampleApp()
 {
-	// empty
+	this->UnloadScene();
 }
 
 
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ExampleApp::ParseArguments(int argc, const char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = (i + 1 < argc);
+
+		if (arg == "--benchmark")
+			this->benchmark = true;
+		else if (arg == "--frames" && hasValue)
+			this->benchmarkFrames = atoi(argv[++i]);
+		else if (arg == "--output" && hasValue)
+			this->benchmarkOutput = argv[++i];
+		else if (arg == "--record" && hasValue)
+			this->recordFile = argv[++i];
+		else if (arg == "--replay" && hasValue)
+			this->replayFile = argv[++i];
+		else if (arg == "--cpu" && hasValue)
+			this->cpuOutput = argv[++i];
+		else if (arg == "--threads" && hasValue)
+			this->cpuThreads = atoi(argv[++i]);
+		else if (arg == "--golden" && hasValue)
+			this->goldenDir = argv[++i];
+		else if (arg == "--golden-update" && hasValue)
+		{
+			this->goldenDir = argv[++i];
+			this->goldenUpdate = true;
+		}
+		else if (arg == "--psnr" && hasValue)
+			this->goldenPSNR = atof(argv[++i]);
+		else if (arg == "--simd" && hasValue)
+		{
+			std::string kernel = argv[++i];
+			if (kernel == "scalar")
+				SimdKernel::Select(SimdKernel::Scalar);
+			else if (kernel == "sse4")
+				SimdKernel::Select(SimdKernel::SSE4);
+			else if (kernel != "avx2")
+			{
+				fprintf(stderr, "Unknown --simd kernel %s\n", kernel.c_str());
+				return false;
+			}
+		}
+		else if (arg == "--trace" && hasValue)
+			this->traceFile = argv[++i];
+		else if (arg == "--width" && hasValue)
+			this->windowWidth = atoi(argv[++i]);
+		else if (arg == "--height" && hasValue)
+			this->windowHeight = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: %s [options]\n", argv[0]);
+			fprintf(stderr, "  --benchmark       Render a camera path in a hidden window and print timings as JSON\n");
+			fprintf(stderr, "  --frames <n>      Length of the built-in benchmark path (default %i)\n", this->benchmarkFrames);
+			fprintf(stderr, "  --output <file>   Also write the benchmark JSON to a file\n");
+			fprintf(stderr, "  --record <file>   Where F5 saves the recorded camera path (default %s)\n", this->recordFile.c_str());
+			fprintf(stderr, "  --replay <file>   Play a recorded camera path at startup, or in the benchmark\n");
+			fprintf(stderr, "  --cpu <file.ppm>  Render one frame with the CPU tracer, no window or GPU needed\n");
+			fprintf(stderr, "  --threads <n>     CPU tracer threads (default one per core)\n");
+			fprintf(stderr, "  --simd <kernel>   CPU tracer kernel: scalar, sse4 or avx2 (default best supported)\n");
+			fprintf(stderr, "  --golden <dir>    Compare CPU renders of fixed poses against the reference images in dir\n");
+			fprintf(stderr, "  --golden-update <dir>  Write new reference images to dir\n");
+			fprintf(stderr, "  --psnr <dB>       Lowest PSNR that passes the golden image check (default %.0f)\n", this->goldenPSNR);
+			fprintf(stderr, "  --trace <file>    Write a Chrome trace of the CPU frame phases when the app closes\n");
+			fprintf(stderr, "  --width <px>      Window width\n");
+			fprintf(stderr, "  --height <px>     Window height\n");
+			return false;
+		}
+	}
+
+	if (this->benchmarkFrames <= 0)
+	{
+		fprintf(stderr, "--frames needs to be at least 1\n");
+		return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+ExampleApp::ExitCode()const
+{
+	return this->exitCode;
+}
+
 //------------------------------------------------------------------------------
 /**
 */
@@ -43,7 +140,27 @@ bool
 ExampleApp::Open()
 {
 	App::Open();
+
+	// The CPU tracer renders without a window or GL context
+	if (!this->cpuOutput.empty() || !this->goldenDir.empty())
+	{
+		this->loader.Start([this](SceneLoader &loader) { this->CreateObjects(loader); });
+		this->loader.Wait();
+		this->loader.Take(this->staticGO, this->dynamicGO);
+		return true;
+	}
+
 	this->window = new Display::Window;
+
+	if (this->windowWidth > 0 && this->windowHeight > 0)
+		this->window->SetSize(this->windowWidth, this->windowHeight);
+
+	// The benchmark runs without a visible window and without mouse input
+	if (this->benchmark)
+	{
+		this->window->SetVisible(false);
+		this->mouseLock = false;
+	}
 	window->SetKeyPressFunction([this](int key, int scancode, int action, int mods)
 	{
 		// W S
@@ -89,11 +206,44 @@ ExampleApp::Open()
 		}
 
 
+		// H to toggle the cost heatmap
+		if (key == GLFW_KEY_H && action == GLFW_PRESS)
+		{
+			this->showHeatmap = !this->showHeatmap;
+		}
+
+
+		// F5 to start and stop recording the camera path
+		if (key == GLFW_KEY_F5 && action == GLFW_PRESS)
+		{
+			if (this->recording)
+				this->StopRecording();
+			else
+				this->StartRecording();
+		}
+
+		// F6 to play the last recorded or loaded camera path
+		if (key == GLFW_KEY_F6 && action == GLFW_PRESS)
+		{
+			if (this->playing)
+				this->StopPlayback();
+			else
+				this->StartPlayback();
+		}
+
+
+		// F to dump the frame time statistics
+		if (key == GLFW_KEY_F && action == GLFW_PRESS)
+		{
+			this->DumpFrameStats();
+		}
+
+
 		// Esc or Space to exit the program
 		if (key == GLFW_KEY_ESCAPE || key == GLFW_KEY_SPACE)
 		{
 			fprintf(stderr, "--- End of ray tracer ---\n");
-			this->window->Close();
+			this->quit = true;
 		}
 	});
 
@@ -172,17 +322,31 @@ ExampleApp::Open()
 		glBindImageTexture(0, this->frameBuffer, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
 
 
+		// Per-pixel cost counters written in debug mode (integer texture, no filtering)
+		glGenTextures(1, &this->costBuffer);
+		glBindTexture(GL_TEXTURE_2D, this->costBuffer);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI, this->texWidth, this->texHeight, 0, GL_RGBA_INTEGER, GL_UNSIGNED_INT, NULL);
+		glBindImageTexture(1, this->costBuffer, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32UI);
+
+		// Frame totals of the cost counters and the ray counters
+		this->costCounters.Init(4, 5);
+		this->rayCounters.Init(3, 6);
+
+
+		// GPU timer queries for the frame statistics
+		this->gpuTimer.Init();
+
+
 		// Compile the compute shader program
 		this->computeShader = new ComputeShader();
 		this->computeShader->InitShader("../resources/compute/rayTracer.glsl");
 
 
-		// Load all the objects for the scene
-		this->CreateObjects();
-	
-		
-
-		// Generate the buffers
+		// Generate the buffers, empty until the objects arrive
 		glGenBuffers(1, &this->staticSSBO);
 		glGenBuffers(1, &this->dynamicSSBO);
 
@@ -190,11 +354,44 @@ ExampleApp::Open()
 		this->SendBuffer(this->dynamicGO, dynamicSSBO, false);
 
 
-		// Bind UI render function
-		this->window->SetUiRender([this]()
+		// Load the objects in the background, frames are rendered with what
+		// has arrived so far
+		this->window->SetTitle("OpenGL Ray Tracer (loading)");
+		this->loader.Start([this](SceneLoader &loader) { this->CreateObjects(loader); });
+
+		// Playback needs the whole scene from the first frame
+		if (!this->replayFile.empty() || this->benchmark)
+		{
+			this->loader.Wait();
+			this->ReceiveObjects();
+		}
+
+
+		// Camera path to play from the start
+		if (!this->replayFile.empty())
 		{
-			this->RenderUI();
-		});
+			if (!this->cameraPath.Load(this->replayFile.c_str()))
+				return false;
+			if (!this->StartPlayback())
+				return false;
+		}
+		else if (this->benchmark)
+		{
+			// The benchmark only ends with the playback, it can't run without one
+			this->BuildLapPath(this->benchmarkFrames);
+			if (!this->StartPlayback())
+				return false;
+		}
+
+
+		// Bind UI render function, the benchmark only measures the ray tracer
+		if (!this->benchmark)
+		{
+			this->window->SetUiRender([this]()
+			{
+				this->RenderUI();
+			});
+		}
 
 		return true;
 	}
@@ -210,15 +407,77 @@ ExampleApp::Open()
 void
 ExampleApp::Run()
 {
+	if (!this->goldenDir.empty())
+	{
+		ThreadPool pool(this->cpuThreads);
+		bool ok;
+		if (this->goldenUpdate)
+			ok = GoldenImages::Update(this->staticGO, this->dynamicGO, this->goldenDir, pool);
+		else
+			ok = GoldenImages::Check(this->staticGO, this->dynamicGO, this->goldenDir, this->goldenPSNR, pool);
+
+		this->exitCode = ok ? 0 : 1;
+		return;
+	}
+
+	if (!this->cpuOutput.empty())
+	{
+		this->RenderCpu();
+		return;
+	}
+
 	Matrix id;
 
-	while (this->window->IsOpen())
+	if (!this->traceFile.empty())
 	{
+		if (!CORE_PROFILER)
+			fprintf(stderr, "Built without CORE_PROFILER, the trace will be empty\n");
+
+		Core::Profiler::SetThreadName("Main");
+		Core::Profiler::Start();
+	}
+
+	while (this->window->IsOpen() && !this->quit)
+	{
+		PROFILE_SCOPE("Frame");
+
 		// Set frame start-time
 		start = std::chrono::system_clock::now();
 
 		// Get inputs
-		this->window->Update();
+		{
+			PROFILE_SCOPE("Input");
+			this->window->Update();
+		}
+
+		// Upload the objects that finished loading since the last frame
+		if (!this->sceneLoaded)
+		{
+			PROFILE_SCOPE("ReceiveObjects");
+			this->ReceiveObjects();
+		}
+
+		// Collect GPU times from earlier frames that have finished
+		this->PollGpuTimes();
+
+		// Counters from earlier frames, divided by the GPU time of the same
+		// frame once both have arrived, whichever comes first
+		{
+			PROFILE_SCOPE("ReadCounters");
+			this->costCounters.Poll();
+			if (this->rayCounters.Poll())
+				this->raysPending = true;
+
+			long long frame = this->rayCounters.GetFrame();
+			int slot = frame % NrRecentGpuTimes;
+			if (this->raysPending && this->recentGpuFrames[slot] == frame && this->recentGpuTimes[slot] > 0.0f)
+			{
+				float seconds = this->recentGpuTimes[slot] / 1000.0f;
+				for (int i = 0; i < 3; i++)
+					this->megaRaysPerSecond[i] = this->rayCounters.Get(i) / seconds / 1000000.0f;
+				this->raysPending = false;
+			}
+		}
 
 
 		// Reset the canvas to remove last frame
@@ -226,133 +485,170 @@ ExampleApp::Run()
 		glClearColor(0.8f, 0.0f, 0.8f, 1.0f);
 
 
-		// Update the view matrix based on input
-		this->camera.Move(dt);
-		//this->camera.Orbit(Vec3(0,1,0), Vec3(0,1,0), 20.0f * dt);
+		// Playback replaces the input with the recorded path
+		if (this->playing)
+		{
+			if (this->playbackFrame == this->cameraPath.NrFrames())
+			{
+				this->StopPlayback();
+				if (this->benchmark)
+					break;
+			}
+			else
+				this->ApplyPlaybackPose();
+		}
 
+		// Wall clock time normally, fixed steps while recording and playing. A
+		// recorded sample is then exactly one playback frame, and playback never
+		// interpolates between two samples on either side of a portal
+		bool fixedStep = this->playing || this->recording;
+		float timestep = fixedStep ? this->cameraPath.timestep : this->dt;
 
-		CollisionInfo info; //defined in EPA.h
-		std::vector<GameObject*> possibleCollisions;
-		LineSweep::FindOverlapingAABB(this->staticGO, this->camera, possibleCollisions);
-		LineSweep::FindOverlapingAABB(this->dynamicGO, this->camera, possibleCollisions);
 
-		for (int i = 0; i < possibleCollisions.size(); i++)
+		// Update the view matrix based on input
+		{
+			PROFILE_SCOPE("Camera::Move");
+			this->camera.Move(timestep);
+			//this->camera.Orbit(Vec3(0,1,0), Vec3(0,1,0), 20.0f * dt);
+		}
+
+
+		// Keep the camera out of walls and move it through portals
 		{
-			Camera *A = &this->camera;
-			GameObject *B = possibleCollisions[i];
-			bool collision = GJK::GJKIntersect(A, B, info);
+			PROFILE_SCOPE("Collision");
 
-			if (collision)
+			CollisionInfo info; //defined in EPA.h
+			std::vector<GameObject*> possibleCollisions;
 			{
-				if (B->isPortal > 0.5f)
+				PROFILE_SCOPE("LineSweep");
+				LineSweep::FindOverlapingAABB(this->staticGO, this->camera, possibleCollisions);
+				LineSweep::FindOverlapingAABB(this->dynamicGO, this->camera, possibleCollisions);
+			}
+
+			for (int i = 0; i < possibleCollisions.size(); i++)
+			{
+				PROFILE_SCOPE("GJK");
+				Camera *A = &this->camera;
+				GameObject *B = possibleCollisions[i];
+				bool collision = GJK::GJKIntersect(A, B, info);
+
+				if (collision)
 				{
-					// Treat the camera as a singularity
-					Matrix rot = B->transform;
-					rot.SetPosition(0, 0, 0);
-					Vec3 objNormal = rot * Vec3(0, 0, -1);
+					if (B->isPortal > 0.5f)
+					{
+						// Treat the camera as a singularity
+						Matrix rot = B->transform;
+						rot.SetPosition(0, 0, 0);
+						Vec3 objNormal = rot * Vec3(0, 0, -1);
 
 
-					// How much to the side and though the portal you are
-					Vec3 offset = this->camera.position - B->transform.GetPosition(); 
+						// How much to the side and though the portal you are
+						Vec3 offset = this->camera.position - B->transform.GetPosition(); 
 
-					// If the collision and obj normal are oposite, tp the camera
-					if (Vec3::Dot(info.collisionNormal, objNormal) < 0.0f &&
-					    fabs(offset.x) < 1.0f && fabs(offset.y) < 1.0f && fabs(offset.z) < 1.0f)
-					{
+						// If the collision and obj normal are oposite, tp the camera
+						if (Vec3::Dot(info.collisionNormal, objNormal) < 0.0f &&
+						    fabs(offset.x) < 1.0f && fabs(offset.y) < 1.0f && fabs(offset.z) < 1.0f)
+						{
 						
-						// Rotate the offset to match the portal exit	
-						offset = Matrix(Vec3(0,1,0), B->cameraRotation) * offset;
+							// Rotate the offset to match the portal exit	
+							offset = Matrix::RotationY(B->cameraRotation / 90) * offset;
 
-						// TP to the exit and add the offset
-						this->camera.position = B->portalPosition + offset;	
+							// TP to the exit and add the offset
+							this->camera.position = B->portalPosition + offset;	
 
-						// How much to rotate the camera
-						this->camera.hAngle += B->cameraRotation;
+							// How much to rotate the camera
+							this->camera.hAngle += B->cameraRotation;
+						}
+					}
+					else
+					{
+						// Don't go into walls
+						this->camera.position += info.collisionNormal * info.penetrationDepth;
 					}
-				}
-				else
-				{
-					// Don't go into walls
-					this->camera.position += info.collisionNormal * info.penetrationDepth;
-				}
 
 				
-				// Same as Move but doesn't use any user input
-				this->camera.Update(dt);
+					// Same as Move but doesn't use any user input
+					this->camera.Update(timestep);
+				}
 			}
 		}
 
 
 
-		// Rotate objects
-		this->dynamicGO[0]->Rotate(Matrix(Vec3(0,1,0), 20.0f * dt)); // Icosphere
-		this->dynamicGO[1]->Rotate(Matrix(Vec3(0,0,1), -20.0f * dt)); // Hexagon
-
-		// Center marker
-		this->dynamicGO[2]->Rotate(Matrix(Vec3(0,1,0), -20.0f * dt));
-
-		// Planet
-		Vec3 planetPos = this->dynamicGO[3]->transform.GetPosition();
-		this->dynamicGO[3]->Orbit(Vec3(0, 7, 0), Vec3(0, 1, 0), 50.0f * dt);
-		this->dynamicGO[3]->Rotate(Matrix(Vec3(0,1,0), 100.0f * dt));
-		Vec3 newPlanetPos = this->dynamicGO[3]->transform.GetPosition();
-		Vec3 planetDeltaPos = newPlanetPos - planetPos;
-
-		// Moon
-		Matrix tmp = this->dynamicGO[4]->transform;
-		tmp.Translate(planetDeltaPos);
-		this->dynamicGO[4]->SetTransform(tmp);
-		this->dynamicGO[4]->Orbit(newPlanetPos, Vec3(0, 1, 0), -120.0f * dt);
-		this->dynamicGO[4]->Rotate(Matrix(Vec3(0,1,0), -100.0f * dt));
-		
-
-
+		// Record the final pose of this frame
+		if (this->recording)
+		{
+			float time = this->cameraPath.Size() * this->cameraPath.timestep;
+			this->cameraPath.Add(time, this->camera.position, this->camera.hAngle, this->camera.vAngle);
+		}
 
-		// Send the new data to GPU
-		this->SendBuffer(this->dynamicGO, this->dynamicSSBO, false);
 
 
+		// Animate the dynamic objects once they have all arrived
+		if (this->sceneLoaded)
+		{
+			PROFILE_SCOPE("Animation");
 
+			this->animator.Update(timestep);
+			GameObject::UpdateTransforms(this->dynamicGO);
+		}
 
-		// Get the four corner rays of the view frustrum
-		Matrix invMVP = Matrix::GetInverse(this->camera.projection * this->camera.view);
-		
-		Vec4 ray00 = invMVP * Vec4(-1.25f, -1, 0, 1);
-		ray00 = ray00 / ray00.w;
-		ray00 -= Vec4(this->camera.position, 1.0f);
 
-		Vec4 ray10 = invMVP * Vec4(1.25f, -1, 0, 1);
-		ray10 = ray10 / ray10.w;
-		ray10 -= Vec4(this->camera.position, 1.0f);
 
-		Vec4 ray01 = invMVP * Vec4(-1.25f, 1, 0, 1);
-		ray01 = ray01 / ray01.w;
-		ray01 -= Vec4(this->camera.position, 1.0f);
+		// Send the new data to GPU
+		{
+			PROFILE_SCOPE("SendBuffer");
+			this->SendBuffer(this->dynamicGO, this->dynamicSSBO, false);
+		}
 
-		Vec4 ray11 = invMVP * Vec4(1.25f, 1, 0, 1);
-		ray11 = ray11 / ray11.w;
-		ray11 -= Vec4(this->camera.position, 1.0f);
 
-		// Send uniforms to shader
-		this->computeShader->UseProgram();
-		this->computeShader->ModifyVector("eye", this->camera.position);
-		this->computeShader->ModifyVector("ray00", Vec3(ray00));
-		this->computeShader->ModifyVector("ray10", Vec3(ray10));
-		this->computeShader->ModifyVector("ray01", Vec3(ray01));
-		this->computeShader->ModifyVector("ray11", Vec3(ray11));
 
 
+		// Set up and dispatch the compute shader
+		{
+			PROFILE_SCOPE("Dispatch");
+
+			// Get the four corner rays of the view frustrum
+			Vec3 ray00, ray10, ray01, ray11;
+			this->camera.GetCornerRays(ray00, ray10, ray01, ray11);
+
+			// Send uniforms to shader
+			this->computeShader->UseProgram();
+			this->computeShader->ModifyVector("eye", this->camera.position);
+			this->computeShader->ModifyVector("ray00", ray00);
+			this->computeShader->ModifyVector("ray10", ray10);
+			this->computeShader->ModifyVector("ray01", ray01);
+			this->computeShader->ModifyVector("ray11", ray11);
+
+			// Fresh counter buffers for this frame
+			this->rayCounters.Bind(this->frameNumber);
+			if (this->showHeatmap)
+				this->costCounters.Bind(this->frameNumber);
+			this->computeShader->ModifyInt("debugMode", this->showHeatmap ? 1 : 0);
+
+
+
+			// Trace the scene to generate an image
+			// 32 * 32 groups rendering 1/32^2 pixels of the image
+			// 8 * 8 groups rendering 1/8^2 pixels each
+			this->gpuTimer.Begin(this->frameNumber);
+			this->computeShader->Draw((this->texWidth + 7) / 8, (this->texHeight + 7) / 8);
+			this->rayCounters.Submit();
+			if (this->showHeatmap)
+				this->costCounters.Submit();
+		}
 
-		// Trace the scene to generate an image
-		// 32 * 32 groups rendering 1/32^2 pixels of the image
-		// 8 * 8 groups rendering 1/8^2 pixels each
-		this->computeShader->Draw(this->texWidth/8, this->texHeight/8);
-	
-		
 
 
 		// Draw a quad with the texture generated by the ray tracer
-		this->quad->Draw(this->frameBuffer);
+		{
+			PROFILE_SCOPE("Draw");
+			if (this->showHeatmap)
+				this->quad->DrawHeatmap(this->costBuffer, this->heatmapChannel, this->heatmapMaxCost);
+			else
+				this->quad->Draw(this->frameBuffer);
+			this->gpuTimer.End();
+		}
 		
 
 
@@ -363,7 +659,10 @@ ExampleApp::Run()
 
 
 		// Show the rendered buffer on the screen
-		this->window->SwapBuffers();
+		{
+			PROFILE_SCOPE("Swap");
+			this->window->SwapBuffers();
+		}
 
 		// Unbind the current program
 		glUseProgram(0);
@@ -372,10 +671,32 @@ ExampleApp::Run()
 		this->end = std::chrono::system_clock::now();
 		std::chrono::duration<double> elapsedTime = end - start;
 		this->dt = elapsedTime.count();
+		this->frameStats.AddCpuTime(this->dt * 1000.0f);
+		this->frameNumber++;
 	}
 
+	if (!this->traceFile.empty())
+	{
+		Core::Profiler::Stop();
+		if (Core::Profiler::WriteChromeTrace(this->traceFile.c_str()))
+			fprintf(stderr, "Wrote trace to %s\n", this->traceFile.c_str());
+	}
+
+	if (this->benchmark)
+		this->PrintBenchmarkResults();
+	else
+		this->DumpFrameStats();
+
+	// Closing the window destroys the context, free what lives in it first
+	this->gpuTimer.Release();
+	this->rayCounters.Release();
+	this->costCounters.Release();
 	delete this->computeShader;
 	delete this->quad;
+	this->computeShader = nullptr;
+	this->quad = nullptr;
+
+	this->window->Close();
 }
 
 
@@ -391,6 +712,61 @@ ExampleApp::RenderUI()
 		ImGui::Begin("Drawing");
 			ImGui::Text("FPS: %.2f", 1/(this->dt));
 			ImGui::Text("dt: %.4f ms", this->dt*1000.0f);
+			ImGui::Text(" ");
+			ImGui::Text("Primary: %8.2f MRays/s (%u)", this->megaRaysPerSecond[0], this->rayCounters.Get(0));
+			ImGui::Text("Portal:  %8.2f MRays/s (%u)", this->megaRaysPerSecond[1], this->rayCounters.Get(1));
+			ImGui::Text("Shadow:  %8.2f MRays/s (%u)", this->megaRaysPerSecond[2], this->rayCounters.Get(2));
+			ImGui::Text("Total:   %8.2f MRays/s",
+				this->megaRaysPerSecond[0] + this->megaRaysPerSecond[1] + this->megaRaysPerSecond[2]);
+		ImGui::End();
+
+		ImGui::Begin("Frame Times");
+		{
+			const FrameTimeRing *rings[2] = { &this->frameStats.cpu, &this->frameStats.gpu };
+			const char *names[2] = { "CPU", "GPU" };
+
+			float lo, hi;
+			this->frameStats.GetHistogramRange(lo, hi);
+
+			for (int i = 0; i < 2; i++)
+			{
+				ImGui::PushID(i);
+				FrameTimeRing::Summary s = rings[i]->GetSummary();
+				ImGui::Text("%s (%i frames)", names[i], s.count);
+				ImGui::Text("  min %.3f  mean %.3f  max %.3f ms", s.min, s.mean, s.max);
+				ImGui::Text("  p50 %.3f  p95 %.3f  p99 %.3f ms", s.p50, s.p95, s.p99);
+
+				std::vector<float> history;
+				rings[i]->GetOrdered(history);
+				if (!history.empty())
+				{
+					ImGui::PlotLines("##history", history.data(), history.size(), 0, "Frame time", 0.0f, hi, ImVec2(0, 50));
+				}
+
+				float bins[FrameStats::HistogramBins];
+				rings[i]->GetHistogram(bins, FrameStats::HistogramBins, lo, hi);
+				ImGui::PlotHistogram("##histogram", bins, FrameStats::HistogramBins, 0,
+					"Histogram", 0.0f, FLT_MAX, ImVec2(0, 50));
+				ImGui::PopID();
+			}
+			ImGui::Text("Histogram range: %.3f - %.3f ms", lo, hi);
+		}
+		ImGui::End();
+
+		ImGui::Begin("Cost Heatmap");
+		{
+			ImGui::Checkbox("Show heatmap", &this->showHeatmap);
+			ImGui::Combo("Counter", &this->heatmapChannel, "AABB tests\0Triangle tests\0Portal hops\0Shadow tests\0\0");
+			ImGui::SliderFloat("Max cost", &this->heatmapMaxCost, 1.0f, 1024.0f, "%.0f", 2.0f);
+
+			const char *names[4] = { "AABB tests", "Triangle tests", "Portal hops", "Shadow tests" };
+			float nrPixels = float(this->texWidth * this->texHeight);
+			for (int i = 0; i < 4; i++)
+			{
+				ImGui::Text("%-15s %10u (%.2f / pixel)", names[i], this->costCounters.Get(i),
+					this->costCounters.Get(i) / nrPixels);
+			}
+		}
 		ImGui::End();
 
 		ImGui::Begin("Camera");
@@ -399,6 +775,10 @@ ExampleApp::RenderUI()
 			ImGui::Text("Position: %.2f, %.2f, %.2f", camPos.x, camPos.y, camPos.z);
 			ImGui::Text("Direction: %.2f, %.2f, %.2f", camDir.x, camDir.y, camDir.z);
 			ImGui::Text("Speed: %.2f", this->camera.speed);
+			if (this->recording)
+				ImGui::Text("Recording: %i samples", this->cameraPath.Size());
+			else if (this->playing)
+				ImGui::Text("Playing: frame %i / %i", this->playbackFrame, this->cameraPath.NrFrames());
 		ImGui::End();
 
 		ImGui::Begin("Controls");
@@ -410,6 +790,10 @@ ExampleApp::RenderUI()
 			ImGui::Text("Sprint:         Shift");
 			ImGui::Text("Toggle Mouse:   Ctrl");
 			ImGui::Text("Reload Shader:  R");
+			ImGui::Text("Frame Stats:    F");
+			ImGui::Text("Cost Heatmap:   H");
+			ImGui::Text("Record Path:    F5");
+			ImGui::Text("Play Path:      F6");
 			ImGui::Text("Quit:           Esc/Space");
 		ImGui::End();
 	}
@@ -420,24 +804,35 @@ ExampleApp::RenderUI()
 /**
 */
 void
-ExampleApp::CreateObjects()
+ExampleApp::CreateObjects(SceneLoader &loader)
 {
 	GameObject *obj;
 
 
-	// Load the static scene file
-	ObjParser::LoadScene("../resources/models/ray_tracer_scene.obj", this->staticGO);
+	// Use the converted scene when it has been built, the text files are only
+	// parsed without it
+	std::vector<GameObject*> staticObjects;
+	if (this->sceneFile.Open(StaticScene::ConvertedFile))
+		this->sceneFile.CreateObjects(staticObjects);
+	else
+	{
+		ThreadPool pool(this->cpuThreads);
+		StaticScene::Create(staticObjects, pool);
+	}
+	loader.Add(staticObjects, true);
 
 
 	obj = ObjParser::LoadMesh("../resources/models/tris/icosphere_lowres_small.obj");
 	obj->SetTransform(Vec3(0-50, -2, 0-5), 0);
 	obj->color = Vec3(0.0f, 0.0f, 1.0f);
-	this->dynamicGO.push_back(obj);
+	this->animator.AddSpin(obj, Vec3(0,1,0), 20.0f);
+	loader.Add(obj, false);
 
 	obj = ObjParser::LoadMesh("../resources/models/quads/hexagon.obj");
 	obj->SetTransform(Vec3(0-50, -5, 0-5), 0);
 	obj->color = Vec3(0.0f, 0.0f, 1.0f);
-	this->dynamicGO.push_back(obj);
+	this->animator.AddSpin(obj, Vec3(0,0,1), -20.0f);
+	loader.Add(obj, false);
 
 
 	// Spinning markers
@@ -448,246 +843,356 @@ ExampleApp::CreateObjects()
 		trans.Scale(2);
 		obj->SetTransform(trans);
 		obj->color = Vec3(0.8f, 0.8f, 0.0f);
-		this->dynamicGO.push_back(obj);
+		this->animator.AddSpin(obj, Vec3(0,1,0), -20.0f);
+		loader.Add(obj, false);
 
-		obj = ObjParser::LoadMesh("../resources/models/tris/icosphere_lowres_small.obj");
-		obj->SetTransform(Vec3(-2.5f, 7, 0), 0);
-		obj->color = Vec3(0.1f, 0.1f, 0.8f);
-		this->dynamicGO.push_back(obj);
+		// Planet and its moon, both are set up before the main thread gets them
+		GameObject *planet = ObjParser::LoadMesh("../resources/models/tris/icosphere_lowres_small.obj");
+		planet->SetTransform(Vec3(-2.5f, 7, 0), 0);
+		planet->color = Vec3(0.1f, 0.1f, 0.8f);
+		this->animator.AddOrbit(planet, Vec3(0, 7, 0), Vec3(0, 1, 0), 50.0f);
+		this->animator.AddSpin(planet, Vec3(0,1,0), 100.0f);
 
 		obj = ObjParser::LoadMesh("../resources/models/tris/icosphere_lowres_small.obj");
 		trans = Matrix();
 		trans.SetPosition(-3.5f, 7, 0);
 		trans.Scale(0.2f);
 		obj->SetTransform(trans);
+		obj->SetParent(planet);
 		obj->color = Vec3(0.3f, 0.3f, 0.3f);
-		this->dynamicGO.push_back(obj);
-	}
 
+		// The planet already turns the moon 150 degrees/s, so this gives -120
+		// degrees/s around the planet and -220 degrees/s of spin in world space
+		this->animator.AddOrbit(obj, Vec3(0, 0, 0), Vec3(0, 1, 0), -270.0f);
+		this->animator.AddSpin(obj, Vec3(0,1,0), -100.0f);
 
-	// Left Arch
-	{
-		// Front
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(-5, 1, 0.499f), 180);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(-6-50, -2, 3.999f);
-		obj->portalNormal = Vec3(0, 0, -1);
-		this->staticGO.push_back(obj);
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(-6-50, -2, -4), 180);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(-5, 1, -0.50f);
-		obj->portalNormal = Vec3(0, 0, -1);
-		this->staticGO.push_back(obj);
-
-		// Back
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(-5, 1, -0.499f), 0);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(-6-50, -2, -3.999f);
-		obj->portalNormal = Vec3(0, 0, 1);
-		this->staticGO.push_back(obj);
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(-6-50, -2, 4), 0);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(-5, 1, 0.50f);
-		obj->portalNormal = Vec3(0, 0, 1);
-		this->staticGO.push_back(obj);
+		loader.Add(planet, false);
+		loader.Add(obj, false);
 	}
 
 
-	// Right Arch
-	{
-		// Left
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(7.001f, 1, 0), 90);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(-3.999f-50, -2, 6);
-		obj->portalNormal = Vec3(1, 0, 0);
-		obj->cameraRotation = 0;
-		this->staticGO.push_back(obj);
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(-4-50, -2, 6), 270);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(7, 1, 0);
-		obj->portalNormal = Vec3(-1, 0, 0);
-		obj->cameraRotation = 0;
-		this->staticGO.push_back(obj);
-
-
-		// Mirror at the back of the corridor
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(4-50, -2, 6), 90);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(3.999f-50, -2, 6);
-		obj->portalNormal = Vec3(-1, 0, 0);
-		obj->cameraRotation = 180;
-		this->staticGO.push_back(obj);
-	}
+}
+
+
+//------------------------------------------------------------------------------
+/**
+	Write the frame time summary next to the executable
+*/
+void
+ExampleApp::DumpFrameStats()
+{
+	this->frameStats.WriteCSV("frame_stats.csv");
+	this->frameStats.WriteJSON("frame_stats.json");
+}
+
 
+//------------------------------------------------------------------------------
+/**
+	Built-in camera path for the benchmark. One lap around the middle of the
+	scene looking at the center, so every arch and portal is in view.
+*/
+void
+ExampleApp::BuildLapPath(const int nrFrames)
+{
+	this->cameraPath.Clear();
 
-	// Back Arch
+	for (int i = 0; i < nrFrames; i++)
 	{
-		// Left
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(-1.5f, 1, -6), 90);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(1.501f, 1, -6);
-		obj->portalNormal = Vec3(1, 0, 0);
-		this->staticGO.push_back(obj);
+		float angle = 360.0f * i / nrFrames;
+		float radians = angle * PI / 180.0f;
 
-		// Right
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(1.5f, 1, -6), 270);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(-1.501f, 1, -6);
-		obj->portalNormal = Vec3(-1, 0, 0);
-		this->staticGO.push_back(obj);
+		Vec3 position(3.5f * sin(radians), 1.5f, 3.5f * cos(radians));
+		this->cameraPath.Add(i * this->cameraPath.timestep, position, angle, -20.0f);
 	}
+}
 
+//------------------------------------------------------------------------------
+/**
+	Put the dynamic objects back where CreateObjects placed them, so
+	recordings and playback start from the same object time
+*/
+void
+ExampleApp::ResetDynamicObjects()
+{
+	for (unsigned int i = 0; i < this->dynamicGO.size(); i++)
+		this->dynamicGO[i]->SetTransform(this->initialDynamicTransforms[i]);
 
-	// Front Arch
-	{
-		// Enter
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(0, 1, 7.001f), 0);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(3-50, -2, -1.999f);
-		obj->portalNormal = Vec3(0, 0, 1);
-		obj->cameraRotation = 0;
-		this->staticGO.push_back(obj);
-
-		// Exit
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(3-50, -2, -2), 180);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(0, 1, 7);
-		obj->portalNormal = Vec3(0, 0, -1);
-		obj->cameraRotation = 0;
-		this->staticGO.push_back(obj);
-
-		// Loop
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(-3-50, -2, 0), 180);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(0-50, -2, 3);
-		obj->portalNormal = Vec3(-1, 0, 0);
-		obj->cameraRotation = 90;
-		this->staticGO.push_back(obj);
+	GameObject::UpdateTransforms(this->dynamicGO);
+	this->animator.Rewind();
+}
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ExampleApp::StartRecording()
+{
+	if (!this->sceneLoaded)
+	{
+		fprintf(stderr, "The scene is still loading\n");
+		return;
 	}
 
-	
-	// 4D Cube
-	{
-		// Back portal
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(0, 1, -1.0001f), 0);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(0-50, -5, -1.0001f-5);
-		obj->portalNormal = Vec3(0, 0, 1);
-		this->staticGO.push_back(obj);
-
-		// Front portal
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(0, 1, 1.0001f), 180);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(0-50, -2, 1.0001f-5);
-		obj->portalNormal = Vec3(0, 0, -1);
-		this->staticGO.push_back(obj);
-		
-		// Right portal
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(1.0001f, 1, 0), 270);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(1.0001f-50, -11, 0-5);
-		obj->portalNormal = Vec3(-1, 0, 0);
-		this->staticGO.push_back(obj);
-
-		// Left portal
-		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
-		obj->SetTransform(Vec3(-1.0001f, 1, 0), 90);
-		obj->isPortal = 1.0f;
-		obj->portalPosition = Vec3(-1.0001f-50, -8, 0-5);
-		obj->portalNormal = Vec3(1, 0, 0);
-		this->staticGO.push_back(obj);
+	this->StopPlayback();
+	this->ResetDynamicObjects();
+
+	this->cameraPath.Clear();
+	this->recording = true;
+	fprintf(stderr, "Recording camera path\n");
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ExampleApp::StopRecording()
+{
+	if (!this->recording)
+		return;
+
+	this->recording = false;
+	this->cameraPath.Save(this->recordFile.c_str());
+}
+
+//------------------------------------------------------------------------------
+/**
+	Returns false when there is no path to play or the scene hasn't loaded
+*/
+bool
+ExampleApp::StartPlayback()
+{
+	this->StopRecording();
+	if (this->cameraPath.Size() == 0)
+	{
+		fprintf(stderr, "No camera path to play\n");
+		return false;
+	}
+	if (!this->sceneLoaded)
+	{
+		fprintf(stderr, "The scene is still loading\n");
+		return false;
 	}
-	
+
+	this->ResetDynamicObjects();
+	this->playbackFrame = 0;
+	this->playing = true;
+	return true;
 }
 
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ExampleApp::StopPlayback()
+{
+	this->playing = false;
+}
 
+//------------------------------------------------------------------------------
+/**
+	Move the camera to the pose of the current playback frame
+*/
 void
-ExampleApp::SendBuffer(std::vector<GameObject*> &go, GLuint ssbo, bool isStatic)
+ExampleApp::ApplyPlaybackPose()
+{
+	CameraSample s = this->cameraPath.Sample(this->playbackFrame * this->cameraPath.timestep);
+	this->playbackFrame++;
+
+	this->camera.position = s.position;
+	this->camera.hAngle = s.hAngle;
+	this->camera.vAngle = s.vAngle;
+
+	this->camera.W = this->camera.A = this->camera.S = false;
+	this->camera.D = this->camera.Q = this->camera.E = false;
+}
+
+//------------------------------------------------------------------------------
+/**
+	Render a single frame with the CPU tracer and write it to cpuOutput.
+	Uses the first pose of the replayed camera path if there is one.
+*/
+void
+ExampleApp::RenderCpu()
 {
-	int nrObjects = go.size();
-	int nrFloats = nrObjects + 1;
-	for (int i = 0; i < nrObjects; i++)
+	int width = (this->windowWidth > 0) ? this->windowWidth : 1024;
+	int height = (this->windowHeight > 0) ? this->windowHeight : 768;
+
+	if (!this->replayFile.empty())
+	{
+		if (!this->cameraPath.Load(this->replayFile.c_str()))
+			return;
+		this->ApplyPlaybackPose();
+	}
+	this->camera.Update(0.0f);
+
+	std::vector<float> staticBuffer, dynamicBuffer;
+	SceneBuffer::Pack(this->staticGO, staticBuffer);
+	SceneBuffer::Pack(this->dynamicGO, dynamicBuffer);
+
+	ThreadPool pool(this->cpuThreads);
+	CpuTracer tracer;
+	tracer.eye = this->camera.position;
+	this->camera.GetCornerRays(tracer.ray00, tracer.ray10, tracer.ray01, tracer.ray11);
+	tracer.SetScene(staticBuffer.data(), dynamicBuffer.data());
+
+	Image image(width, height);
+	std::chrono::time_point<std::chrono::system_clock> renderStart = std::chrono::system_clock::now();
+	tracer.Render(width, height, image.pixels.data(), pool);
+	std::chrono::duration<double> renderTime = std::chrono::system_clock::now() - renderStart;
+
+	unsigned long long nrRays = tracer.stats.primaryRays + tracer.stats.portalRays + tracer.stats.shadowRays;
+	fprintf(stderr, "Rendered %ix%i on %i threads (%s) in %.2f ms, %.2f MRays/s\n",
+		width, height, pool.NrThreads(), SimdKernel::Name(SimdKernel::Selected()),
+		renderTime.count() * 1000.0, nrRays / renderTime.count() / 1e6);
+
+	if (image.WritePPM(this->cpuOutput.c_str()))
+		fprintf(stderr, "Wrote %s\n", this->cpuOutput.c_str());
+}
+
+//------------------------------------------------------------------------------
+/**
+	Add the GPU times that have finished to the stats, and remember them by
+	frame number for the ray counters
+*/
+void
+ExampleApp::PollGpuTimes()
+{
+	float gpuMs;
+	long long frame;
+	while (this->gpuTimer.Poll(gpuMs, frame))
 	{
-		nrFloats += go[i]->NrValues();
+		this->frameStats.AddGpuTime(gpuMs);
 
-		// 			nrVerts,	isPortal, 	pos,	normal, color
-		nrFloats += 1 + 		1 + 		3 +		3 + 	3;
+		int slot = frame % NrRecentGpuTimes;
+		this->recentGpuFrames[slot] = frame;
+		this->recentGpuTimes[slot] = gpuMs;
 	}
+}
+
+//------------------------------------------------------------------------------
+/**
+	Print the benchmark timings as JSON to stdout, and to a file if requested
+*/
+void
+ExampleApp::PrintBenchmarkResults()
+{
+	// Let the last frames finish so their GPU times are included
+	glFinish();
+	this->PollGpuTimes();
+
+	const char *path = this->replayFile.empty() ? "lap" : this->replayFile.c_str();
 
-	// Create the array that will be sent to GPU
-	float *arr = new float[nrFloats];
-	int index = 0;
+	char buf[512];
+	snprintf(buf, sizeof(buf), "{\n\"path\": \"%s\",\n\"frames\": %i,\n\"width\": %i,\n\"height\": %i,\n\"renderer\": \"%s\",\n\"stats\": ",
+		path, this->cameraPath.NrFrames(), this->texWidth, this->texHeight, (const char*)glGetString(GL_RENDERER));
 
-	arr[index++] = nrObjects;
+	std::string json = buf;
+	json += this->frameStats.ToJSON();
+	json += "\n}\n";
 
-	// First values are nr of floats in each object
-	for (int i = 0; i < nrObjects; i++)
+	printf("%s", json.c_str());
+
+	if (!this->benchmarkOutput.empty())
+	{
+		FILE *file = fopen(this->benchmarkOutput.c_str(), "w");
+		if (file != nullptr)
+		{
+			fprintf(file, "%s", json.c_str());
+			fclose(file);
+		}
+		else
+			fprintf(stderr, "Could not write benchmark results to %s\n", this->benchmarkOutput.c_str());
+	}
+}
+
+
+//------------------------------------------------------------------------------
+/**
+	Take the objects the loader has finished and upload them. The static
+	buffer is only sent again when static objects arrived, the dynamic one is
+	sent every frame anyway
+*/
+void
+ExampleApp::ReceiveObjects()
+{
+	size_t nrStatic = this->staticGO.size();
+	bool finished = this->loader.Take(this->staticGO, this->dynamicGO);
+
+	if (this->staticGO.size() != nrStatic)
 	{
-		//   nrVerts, isPortal, position, normal, color = 11
-		arr[index++] = go[i]->NrValues() + 11;
+		this->SendBuffer(this->staticGO, this->staticSSBO, true);
+
+		// The GPU has its own copy of the converted scene now
+		this->sceneFile.Close();
 	}
 
-	// Add all values
-	for (int i = 0; i < nrObjects; i++)
+	if (finished)
 	{
-		// Quad or tri
-		arr[index++] = go[i]->nrVerts;
+		// Starting poses for recording and playback
+		for (unsigned int i = 0; i < this->dynamicGO.size(); i++)
+			this->initialDynamicTransforms.push_back(this->dynamicGO[i]->localTransform);
+
+		this->sceneLoaded = true;
+		this->window->SetTitle("OpenGL Ray Tracer");
+	}
+}
 
-		// isPortal
-		arr[index++] = go[i]->isPortal;
+//------------------------------------------------------------------------------
+/**
+	Delete every object. The loader may still be creating them, so wait for
+	it and take what it has queued, or it would delete those a second time
+*/
+void
+ExampleApp::UnloadScene()
+{
+	this->loader.Wait();
+	this->loader.Take(this->staticGO, this->dynamicGO);
+
+	this->animator.Clear();
+	this->staticGO.clear();
+	this->dynamicGO.clear();
+	this->dynamicUpload.clear();
+	this->initialDynamicTransforms.clear();
+	this->sceneLoaded = false;
 
-		// Portal position
-		arr[index++] = go[i]->portalPosition.x;
-		arr[index++] = go[i]->portalPosition.y;
-		arr[index++] = go[i]->portalPosition.z;
+	GameObjectPool::DestroyAll();
+}
 
-		// Portal normal
-		arr[index++] = go[i]->portalNormal.x;
-		arr[index++] = go[i]->portalNormal.y;
-		arr[index++] = go[i]->portalNormal.z;
 
-		// Color of object
-		arr[index++] = go[i]->color.x;
-		arr[index++] = go[i]->color.y;
-		arr[index++] = go[i]->color.z;
+void
+ExampleApp::SendBuffer(std::vector<GameObject*> &go, GLuint ssbo, bool isStatic)
+{
+	const float *arr;
+	size_t size;
 
-		// AABB
-		arr[index++] = go[i]->values[0];
-		arr[index++] = go[i]->values[1];
-		arr[index++] = go[i]->values[2];
-		arr[index++] = go[i]->values[3];
-		arr[index++] = go[i]->values[4];
-		arr[index++] = go[i]->values[5];
+	// The same dynamic objects as last time, only upload the ones that moved
+	if (!isStatic && !this->dynamicUpload.empty() && this->dynamicUpload[0] == go.size())
+	{
+		size_t first, last;
+		SceneBuffer::Update(go, this->dynamicUpload, first, last);
 
-		for (int j = 6; j < go[i]->NrValues(); j += 3)
+		if (first < last)
 		{
-			// Apply transformations
-			Vec3 vert(go[i]->values[j], go[i]->values[j+1], go[i]->values[j+2]);
-			vert = go[i]->transform * vert;
-
-			// Insert transformed vertex positions
-			arr[index++] = vert.x;
-			arr[index++] = vert.y;
-			arr[index++] = vert.z;
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * first, sizeof(float) * (last - first), &this->dynamicUpload[first]);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 		}
+		return;
 	}
 
+	// The converted scene is already packed, upload it from the mapped file
+	if (isStatic && this->sceneFile.GpuData() != nullptr)
+	{
+		arr = this->sceneFile.GpuData();
+		size = this->sceneFile.GpuSize();
+	}
+	else
+	{
+		std::vector<float> &buffer = isStatic ? this->uploadBuffer : this->dynamicUpload;
+		SceneBuffer::Pack(go, buffer);
+		arr = buffer.data();
+		size = sizeof(float) * buffer.size();
+	}
 
 
 	// Bind the active buffer
@@ -696,20 +1201,19 @@ ExampleApp::SendBuffer(std::vector<GameObject*> &go, GLuint ssbo, bool isStatic)
 	// Send the static data to binding 3 once
 	if (isStatic)
 	{
-		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * nrFloats, arr, GL_STATIC_COPY);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, arr, GL_STATIC_COPY);
 		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, ssbo);
 	}
 
 	// Send the dynamic data to binding 4 every frame
 	else
 	{
-		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * nrFloats, arr, GL_DYNAMIC_COPY);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, arr, GL_DYNAMIC_COPY);
 		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, ssbo);
 	}
 
 
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-	delete[] arr;
 }
 
 
@@ -21,6 +21,19 @@
 #include "EPA.h"
 #include "camera.h"
 #include "objParser.h"
+#include "frameStats.h"
+#include "gpuTimer.h"
+#include "shaderCounters.h"
+#include "cameraPath.h"
+#include "sceneBuffer.h"
+#include "cpuTracer.h"
+#include "threadPool.h"
+#include "image.h"
+#include "goldenImages.h"
+#include "staticScene.h"
+#include "sceneFile.h"
+#include "sceneLoader.h"
+#include "animator.h"
 
 #include <vector>
 #include <chrono>
@@ -36,15 +49,32 @@ public:
 	/// destructor
 	~ExampleApp();
 
+	/// parse command line options, returns false if the app should not start
+	bool ParseArguments(int argc, const char** argv);
 	/// open app
 	bool Open();
 	/// run app
 	void Run();
+	/// process exit code, non-zero if a check failed
+	int ExitCode()const;
 private:
 
 	void RenderUI();
-	void CreateObjects();
+	void CreateObjects(SceneLoader &loader);
+	void ReceiveObjects();
 	void SendBuffer(std::vector<GameObject*> &go, GLuint ssbo, bool isStatic);
+	void DumpFrameStats();
+	void PollGpuTimes();
+	void PrintBenchmarkResults();
+	void RenderCpu();
+	void BuildLapPath(const int nrFrames);
+	void ResetDynamicObjects();
+	void UnloadScene();
+	void StartRecording();
+	void StopRecording();
+	bool StartPlayback();
+	void StopPlayback();
+	void ApplyPlaybackPose();
 
 	Display::Window* window;
 
@@ -52,6 +82,8 @@ private:
 	bool lClicking = false;
 	bool rClicking = false;
 	bool mouseLock = true;
+	// Esc was pressed, the window is closed after Run has freed the GL objects
+	bool quit = false;
 	float oldMouseX = 0;
 	float oldMouseY = 0;
 	float mouseSpeed = 0.1f;
@@ -65,17 +97,85 @@ private:
 
 	// Environment
 	GLuint staticSSBO, dynamicSSBO;
+	std::vector<float> uploadBuffer;
+
+	// Packed dynamic objects, kept so only the ones that move are repacked
+	std::vector<float> dynamicUpload;
 	std::vector<GameObject*> staticGO;
 	std::vector<GameObject*> dynamicGO;
+	SceneFile sceneFile;
 
 	// Compute Shader
 	ComputeShader *computeShader = nullptr;
 	int texWidth, texHeight;
 	GLuint frameBuffer;
 
+	// Per-pixel cost heatmap (debug mode)
+	GLuint costBuffer;
+	ShaderCounters costCounters;
+	bool showHeatmap = false;
+	int heatmapChannel = 0;
+	float heatmapMaxCost = 64.0f;
+
+	// Primary, portal and shadow rays traced per frame
+	ShaderCounters rayCounters;
+	float megaRaysPerSecond[3] = {0.0f, 0.0f, 0.0f};
+	// The latest ray counts are still waiting for the GPU time of their frame
+	bool raysPending = false;
+
 
 	float dt = 0; 		// Total frame time
 	std::chrono::time_point<std::chrono::system_clock> start, end;
 	long long counter = 0;
+
+	// Frame time history
+	FrameStats frameStats;
+	GpuTimer gpuTimer;
+	long long frameNumber = 0;
+
+	// GPU times of the last few frames, slot frame % NrRecentGpuTimes, so the
+	// ray counts are divided by the time of the frame they were counted in
+	static const int NrRecentGpuTimes = 8;
+	long long recentGpuFrames[NrRecentGpuTimes];
+	float recentGpuTimes[NrRecentGpuTimes];
+
+	// Window size from the command line, 0 keeps the default
+	int windowWidth = 0;
+	int windowHeight = 0;
+
+	// Headless benchmark, plays a camera path and prints the frame times
+	bool benchmark = false;
+	int benchmarkFrames = 600;
+	std::string benchmarkOutput;
+
+	// Camera path recording and fixed timestep playback
+	CameraPath cameraPath;
+	bool recording = false;
+	bool playing = false;
+	int playbackFrame = 0;
+	std::string recordFile = "camera_path.bin";
+	std::string replayFile;
+	std::vector<Matrix> initialDynamicTransforms;
+
+	// Headless CPU rendering
+	std::string cpuOutput;
+	int cpuThreads = 0;
+
+	// Golden image check of the CPU tracer
+	std::string goldenDir;
+	bool goldenUpdate = false;
+	float goldenPSNR = 40.0f;
+	int exitCode = 0;
+
+	// Chrome trace of the frame phases, written when the app closes
+	std::string traceFile;
+
+	// Spin and orbit of the dynamic objects, set up by CreateObjects
+	Animator animator;
+
+	// Loads the objects on a worker thread. Last so it is destroyed first,
+	// the thread is done with the members above before they go
+	SceneLoader loader;
+	bool sceneLoaded = false;
 };
 } // namespace Example
\ No newline at end of file
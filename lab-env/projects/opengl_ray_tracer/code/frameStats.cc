@@ -0,0 +1,232 @@
+#include "frameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+
+FrameTimeRing::FrameTimeRing()
+{}
+
+FrameTimeRing::~FrameTimeRing()
+{}
+
+
+void FrameTimeRing::Add(const float ms)
+{
+	this->samples[this->next] = ms;
+	this->next = (this->next + 1) % Capacity;
+
+	if (this->count < Capacity)
+		this->count++;
+}
+
+void FrameTimeRing::Clear()
+{
+	this->next = 0;
+	this->count = 0;
+}
+
+int FrameTimeRing::Size()const
+{
+	return this->count;
+}
+
+float FrameTimeRing::Latest()const
+{
+	if (this->count == 0)
+		return 0.0f;
+
+	return this->samples[(this->next + Capacity - 1) % Capacity];
+}
+
+void FrameTimeRing::GetOrdered(std::vector<float> &out)const
+{
+	out.resize(this->count);
+
+	// Oldest sample is at next once the ring has wrapped
+	int start = (this->count < Capacity) ? 0 : this->next;
+	for (int i = 0; i < this->count; i++)
+		out[i] = this->samples[(start + i) % Capacity];
+}
+
+FrameTimeRing::Summary FrameTimeRing::GetSummary()const
+{
+	Summary s;
+	if (this->count == 0)
+		return s;
+
+	std::vector<float> sorted(this->samples, this->samples + this->count);
+	std::sort(sorted.begin(), sorted.end());
+
+	double sum = 0.0;
+	for (int i = 0; i < this->count; i++)
+		sum += sorted[i];
+
+	// Nearest-rank percentiles
+	auto percentile = [&sorted](const float p)
+	{
+		int rank = (int)std::ceil(p * sorted.size()) - 1;
+		rank = std::max(0, std::min(rank, (int)sorted.size() - 1));
+		return sorted[rank];
+	};
+
+	s.count = this->count;
+	s.min = sorted.front();
+	s.max = sorted.back();
+	s.mean = float(sum / this->count);
+	s.p50 = percentile(0.50f);
+	s.p95 = percentile(0.95f);
+	s.p99 = percentile(0.99f);
+
+	return s;
+}
+
+void FrameTimeRing::GetHistogram(float *bins, const int nrBins, const float lo, const float hi)const
+{
+	for (int i = 0; i < nrBins; i++)
+		bins[i] = 0.0f;
+
+	float range = hi - lo;
+	if (range <= 0.0f)
+		range = 1.0f;
+
+	for (int i = 0; i < this->count; i++)
+	{
+		int bin = (int)((this->samples[i] - lo) / range * nrBins);
+		bin = std::max(0, std::min(bin, nrBins - 1));
+		bins[bin] += 1.0f;
+	}
+}
+
+
+
+FrameStats::FrameStats()
+{}
+
+FrameStats::~FrameStats()
+{}
+
+
+void FrameStats::AddCpuTime(const float ms)
+{
+	this->cpu.Add(ms);
+}
+
+void FrameStats::AddGpuTime(const float ms)
+{
+	this->gpu.Add(ms);
+}
+
+void FrameStats::Clear()
+{
+	this->cpu.Clear();
+	this->gpu.Clear();
+}
+
+void FrameStats::GetHistogramRange(float &lo, float &hi)const
+{
+	FrameTimeRing::Summary c = this->cpu.GetSummary();
+	FrameTimeRing::Summary g = this->gpu.GetSummary();
+
+	lo = c.min;
+	hi = c.max;
+	if (g.count > 0)
+	{
+		lo = (c.count > 0) ? std::min(lo, g.min) : g.min;
+		hi = std::max(hi, g.max);
+	}
+}
+
+bool FrameStats::WriteCSV(const char *filename)const
+{
+	FILE *file = fopen(filename, "w");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not write frame stats to %s\n", filename);
+		return false;
+	}
+
+	const FrameTimeRing *rings[2] = { &this->cpu, &this->gpu };
+	const char *names[2] = { "cpu", "gpu" };
+
+	fprintf(file, "timer,count,min_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n");
+	for (int i = 0; i < 2; i++)
+	{
+		FrameTimeRing::Summary s = rings[i]->GetSummary();
+		fprintf(file, "%s,%i,%f,%f,%f,%f,%f,%f\n",
+			names[i], s.count, s.min, s.mean, s.p50, s.p95, s.p99, s.max);
+	}
+
+	// Histogram with the bin start as the first column
+	float lo, hi;
+	float bins[2][HistogramBins];
+	this->GetHistogramRange(lo, hi);
+	this->cpu.GetHistogram(bins[0], HistogramBins, lo, hi);
+	this->gpu.GetHistogram(bins[1], HistogramBins, lo, hi);
+
+	fprintf(file, "\nbin_start_ms,cpu_count,gpu_count\n");
+	for (int i = 0; i < HistogramBins; i++)
+	{
+		float binStart = lo + (hi - lo) * i / HistogramBins;
+		fprintf(file, "%f,%i,%i\n", binStart, (int)bins[0][i], (int)bins[1][i]);
+	}
+
+	fclose(file);
+	fprintf(stderr, "Wrote frame stats to %s\n", filename);
+	return true;
+}
+
+std::string FrameStats::ToJSON()const
+{
+	std::string json;
+	char buf[256];
+
+	const FrameTimeRing *rings[2] = { &this->cpu, &this->gpu };
+	const char *names[2] = { "cpu", "gpu" };
+
+	float lo, hi;
+	this->GetHistogramRange(lo, hi);
+
+	json += "{\n";
+	for (int i = 0; i < 2; i++)
+	{
+		FrameTimeRing::Summary s = rings[i]->GetSummary();
+		snprintf(buf, sizeof(buf),
+			"\t\"%s\": {\"count\": %i, \"min_ms\": %f, \"mean_ms\": %f, \"p50_ms\": %f, "
+			"\"p95_ms\": %f, \"p99_ms\": %f, \"max_ms\": %f, \"histogram\": [",
+			names[i], s.count, s.min, s.mean, s.p50, s.p95, s.p99, s.max);
+		json += buf;
+
+		float bins[HistogramBins];
+		rings[i]->GetHistogram(bins, HistogramBins, lo, hi);
+		for (int j = 0; j < HistogramBins; j++)
+		{
+			snprintf(buf, sizeof(buf), (j == 0) ? "%i" : ", %i", (int)bins[j]);
+			json += buf;
+		}
+		json += "]},\n";
+	}
+
+	snprintf(buf, sizeof(buf), "\t\"histogram_range_ms\": [%f, %f]\n}", lo, hi);
+	json += buf;
+
+	return json;
+}
+
+bool FrameStats::WriteJSON(const char *filename)const
+{
+	FILE *file = fopen(filename, "w");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not write frame stats to %s\n", filename);
+		return false;
+	}
+
+	std::string json = this->ToJSON();
+	fprintf(file, "%s\n", json.c_str());
+
+	fclose(file);
+	fprintf(stderr, "Wrote frame stats to %s\n", filename);
+	return true;
+}
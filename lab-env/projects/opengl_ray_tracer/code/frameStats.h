@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+
+// Fixed size history of frame times (in milliseconds)
+class FrameTimeRing
+{
+public:
+
+	static const int Capacity = 1024;
+
+	struct Summary
+	{
+		int count = 0;
+		float min = 0.0f;
+		float mean = 0.0f;
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+	};
+
+
+	FrameTimeRing();
+	~FrameTimeRing();
+
+	void Add(const float ms);
+	void Clear();
+
+	int Size()const;
+	float Latest()const;
+
+	// Oldest to newest, so the samples can be plotted directly
+	void GetOrdered(std::vector<float> &out)const;
+
+	Summary GetSummary()const;
+
+	// Count the samples into nrBins equally sized bins between lo and hi
+	void GetHistogram(float *bins, const int nrBins, const float lo, const float hi)const;
+
+private:
+
+	float samples[Capacity];
+	int next = 0;
+	int count = 0;
+};
+
+
+class FrameStats
+{
+public:
+
+	static const int HistogramBins = 32;
+
+	FrameTimeRing cpu;
+	FrameTimeRing gpu;
+
+
+	FrameStats();
+	~FrameStats();
+
+	void AddCpuTime(const float ms);
+	void AddGpuTime(const float ms);
+	void Clear();
+
+	// Summary and histogram of both rings
+	bool WriteCSV(const char *filename)const;
+	bool WriteJSON(const char *filename)const;
+	std::string ToJSON()const;
+
+	// Histogram range shared by the CPU and GPU ring so they can be compared
+	void GetHistogramRange(float &lo, float &hi)const;
+};
@@ -30,12 +30,17 @@ FullScreenQuad::FullScreenQuad()
 	// Set shader for the quad
 	this->shader = new ShaderResource;
 	this->shader->SetShader("../resources/shaders/basic.vertexshader", "../resources/shaders/basic.fragmentshader");
+
+	// False-color view of the per-pixel cost
+	this->heatmapShader = new ShaderResource;
+	this->heatmapShader->SetShader("../resources/shaders/basic.vertexshader", "../resources/shaders/heatmap.fragmentshader");
 }
 
 
 FullScreenQuad::~FullScreenQuad()
 {
 	delete this->shader;
+	delete this->heatmapShader;
 }
 
 
@@ -43,10 +48,25 @@ FullScreenQuad::~FullScreenQuad()
 void FullScreenQuad::Draw(GLuint frameBuffer)
 {
 	this->shader->UseProgram();
+	this->DrawQuad(frameBuffer);
+}
+
+
+// Render the integer cost texture as a heatmap, maxCost is the hottest value
+void FullScreenQuad::DrawHeatmap(GLuint costBuffer, int channel, float maxCost)
+{
+	this->heatmapShader->UseProgram();
+	this->heatmapShader->ModifyInt("channel", channel);
+	this->heatmapShader->ModifyFloat("maxCost", maxCost);
+	this->DrawQuad(costBuffer);
+}
 
+
+void FullScreenQuad::DrawQuad(GLuint texture)
+{
 	// Activate texture
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, frameBuffer);
+	glBindTexture(GL_TEXTURE_2D, texture);
 
 	// Draw the quad
 	glBindBuffer(GL_ARRAY_BUFFER, this->quad);
@@ -10,8 +10,13 @@ public:
 	~FullScreenQuad();
 
 	void Draw(GLuint frameBuffer);
+	void DrawHeatmap(GLuint costBuffer, int channel, float maxCost);
 
 
 	GLuint quad;
 	ShaderResource *shader;
+	ShaderResource *heatmapShader;
+
+private:
+	void DrawQuad(GLuint texture);
 };
\ No newline at end of file
@@ -1,57 +1,126 @@
 #include "gameObject.h"
 
+#include <algorithm>
+
 GameObject::GameObject()
 {
 	this->color = Vec3(1.0f, 1.0f, 1.0f);
+
+	// Empty until vertices are added
+	this->localMin = Vec3(10000, 10000, 10000);
+	this->localMax = -this->localMin;
+	this->aabbMin = this->localMin;
+	this->aabbMax = this->localMax;
 }
 
 GameObject::~GameObject()
-{}
+{
+	this->SetParent(nullptr);
 
+	// Orphans keep their world transform, as with SetParent(nullptr)
+	while (!this->children.empty())
+		this->children.back()->SetParent(nullptr);
+}
 
-int GameObject::NrValues()
+void* GameObject::operator new(size_t size)
 {
-	return this->values.size();
+	return GameObjectPool::Allocate(size);
 }
 
-void GameObject::SetTransform(const Matrix &m)
+void GameObject::operator delete(void *p)
 {
-	this->transform = m;
+	GameObjectPool::Free(p);
+}
+
+GameObjectPool::Handle GameObject::GetHandle()const
+{
+	return GameObjectPool::GetHandle(this);
+}
+
+
+int GameObject::NrPositions()const
+{
+	return this->xs.size();
+}
+
+// Recalculate both AABBs after the vertices changed
+void GameObject::UpdateAABB()
+{
+	Vec3 min(10000, 10000, 10000);
+	Vec3 max = -min;
+
+	for (size_t i = 0; i < this->xs.size(); i++)
+	{
+		if (this->xs[i] < min.x) min.x = this->xs[i];
+		if (this->ys[i] < min.y) min.y = this->ys[i];
+		if (this->zs[i] < min.z) min.z = this->zs[i];
+
+		if (this->xs[i] > max.x) max.x = this->xs[i];
+		if (this->ys[i] > max.y) max.y = this->ys[i];
+		if (this->zs[i] > max.z) max.z = this->zs[i];
+	}
+
+	this->localMin = min;
+	this->localMax = max;
+
+	this->UpdateWorldAABB();
+	this->hullDirty = true;
+}
+
+// From the local bounds, the same cost for every mesh
+void GameObject::UpdateWorldAABB()
+{
+	if (this->xs.empty())
+	{
+		this->aabbMin = this->localMin;
+		this->aabbMax = this->localMax;
+		return;
+	}
+
+	this->transform.TransformBox(this->localMin, this->localMax, this->aabbMin, this->aabbMax);
+}
 
+// Tight world bounds of the transformed vertices, for objects that don't move
+// often enough for it to matter
+void GameObject::FitAABB()
+{
 	Vec3 min(10000, 10000, 10000);
 	Vec3 max = -min;
-	Vec3 v;
 
-	// Recalculate AABB
-	for (int i = 6; i < values.size(); i+=3)
+	if (!this->xs.empty())
+		this->transform.TransformAABB(this->xs.data(), this->ys.data(), this->zs.data(), this->xs.size(), min, max);
+
+	this->aabbMin = min;
+	this->aabbMax = max;
+}
+
+ConvexHull& GameObject::GetHull()
+{
+	if (this->hullDirty)
+	{
+		this->hull.Build(this->xs.data(), this->ys.data(), this->zs.data(), this->xs.size());
+		this->hullDirty = false;
+	}
+
+	return this->hull;
+}
+
+void GameObject::SetTransform(const Matrix &m)
+{
+	this->localTransform = m;
+
+	for (size_t i = 0; i < this->children.size(); i++)
+		this->children[i]->dirty = true;
+
+	if (this->parent != nullptr)
 	{
-		v = Vec3(values[i+0], values[i+1], values[i+2]);
-		v = m * v;
-		// this->values[i+0] = v.x;
-		// this->values[i+1] = v.y;
-		// this->values[i+2] = v.z;
-
-		// AABB
-		if (v.x < min.x)
-			min.x = v.x;
-		if (v.y < min.y)
-			min.y = v.y;
-		if (v.z < min.z)
-			min.z = v.z;
-
-		if (v.x > max.x)
-			max.x = v.x;
-		if (v.y > max.y)
-			max.y = v.y;
-		if (v.z > max.z)
-			max.z = v.z;
+		this->dirty = true;
+		return;
 	}
-	this->values[0] = min.x;
-	this->values[1] = min.y;
-	this->values[2] = min.z;
-	this->values[3] = max.x;
-	this->values[4] = max.y;
-	this->values[5] = max.z;
+
+	this->transform = m;
+	this->UpdateWorldAABB();
+	this->moved = true;
 
 
 	// Rotate OBB
@@ -68,42 +137,37 @@ void GameObject::SetTransform(const Vec3 &pos, const float rot)
 	this->SetTransform(m);
 }
 
-void GameObject::SetAABB(const Vec3 &min, const Vec3 &max)
+
+void GameObject::Rotate(const Matrix &m)
 {
-	// AABBmax
-	this->values.insert(this->values.begin(), max.z);
-	this->values.insert(this->values.begin(), max.y);
-	this->values.insert(this->values.begin(), max.x);
-	// AABBmin
-	this->values.insert(this->values.begin(), min.z);
-	this->values.insert(this->values.begin(), min.y);
-	this->values.insert(this->values.begin(), min.x);
+	this->SetTransform(RotateMatrix(this->localTransform, m));
 }
 
+void GameObject::Orbit(const Vec3 &point, const Vec3 &axis, const float speed)
+{
+	this->SetTransform(OrbitMatrix(this->localTransform, point, Matrix(axis, speed)));
+}
 
-void GameObject::Rotate(const Matrix &m)
+Matrix GameObject::RotateMatrix(const Matrix &transform, const Matrix &rotation)
 {
-	// Get current transform
-	Matrix tmpMat = this->transform;
+	Matrix tmpMat = transform;
 
 	// Save pos and move to origo
 	Vec3 oldPos = tmpMat.GetPosition();
 	tmpMat.SetPosition(0,0,0);
 
 	// Rotate
-	tmpMat = m * tmpMat;
+	tmpMat = rotation * tmpMat;
 
 	// Move back to pos
 	tmpMat.SetPosition(oldPos);
 
-	// Save the new transform
-	this->SetTransform(tmpMat);
+	return tmpMat;
 }
 
-void GameObject::Orbit(const Vec3 &point, const Vec3 &axis, const float speed)
+Matrix GameObject::OrbitMatrix(const Matrix &transform, const Vec3 &point, const Matrix &rotation)
 {
-	// Get current transform
-	Matrix tmpMat = this->transform;
+	Matrix tmpMat = transform;
 	Vec3 oldPos = tmpMat.GetPosition();
 
 	// obj-obj distance --> obj-origo distance
@@ -111,11 +175,97 @@ void GameObject::Orbit(const Vec3 &point, const Vec3 &axis, const float speed)
 	tmpMat.SetPosition(orbitPos);
 
 	// Rotate
-	tmpMat = Matrix(axis, speed) * tmpMat;
+	tmpMat = rotation * tmpMat;
 
 	// Move back to pos
 	tmpMat.Translate(point);
 
-	// Save the new transform
-	this->SetTransform(tmpMat);
-}
\ No newline at end of file
+	return tmpMat;
+}
+
+
+void GameObject::SetParent(GameObject *parent)
+{
+	// Apply a pending local change first, the local transform is made again
+	// from the world transform below
+	if (this->IsStale())
+	{
+		this->transform = this->CurrentTransform();
+		this->UpdateWorldAABB();
+		this->moved = true;
+
+		for (size_t i = 0; i < this->children.size(); i++)
+			this->children[i]->dirty = true;
+	}
+
+	if (this->parent != nullptr)
+	{
+		std::vector<GameObject*> &siblings = this->parent->children;
+		siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+	}
+
+	this->parent = parent;
+	this->dirty = false;
+
+	if (parent == nullptr)
+	{
+		this->localTransform = this->transform;
+		return;
+	}
+
+	parent->children.push_back(this);
+	this->localTransform = Matrix::GetAffineInverse(parent->CurrentTransform()) * this->transform;
+}
+
+GameObject* GameObject::GetParent()const
+{
+	return this->parent;
+}
+
+bool GameObject::IsStale()const
+{
+	for (const GameObject *go = this; go->parent != nullptr; go = go->parent)
+	{
+		if (go->dirty)
+			return true;
+	}
+	return false;
+}
+
+Matrix GameObject::CurrentTransform()const
+{
+	if (!this->IsStale())
+		return this->transform;
+
+	return this->parent->CurrentTransform() * this->localTransform;
+}
+
+
+void GameObject::UpdateSubtree(bool parentMoved)
+{
+	if (this->dirty || parentMoved)
+	{
+		this->transform = this->parent->transform * this->localTransform;
+		this->UpdateWorldAABB();
+		this->moved = true;
+		this->dirty = false;
+		parentMoved = true;
+	}
+
+	for (size_t i = 0; i < this->children.size(); i++)
+		this->children[i]->UpdateSubtree(parentMoved);
+}
+
+void GameObject::UpdateTransforms(const std::vector<GameObject*> &objects)
+{
+	// The roots are always up to date, start from their children
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		GameObject *go = objects[i];
+		if (go->parent != nullptr)
+			continue;
+
+		for (size_t j = 0; j < go->children.size(); j++)
+			go->children[j]->UpdateSubtree(false);
+	}
+}
@@ -5,6 +5,8 @@
 
 #include "mathMatrix.h"
 #include "mathVec3.h"
+#include "gameObjectPool.h"
+#include "convexHull.h"
 
 
 class GameObject
@@ -12,11 +14,31 @@ class GameObject
 private:
 
 	void LoadMesh(const char *filename);
+	void UpdateWorldAABB();
+	void UpdateSubtree(bool parentMoved);
+
+	// True when this or an ancestor has a local change UpdateTransforms hasn't
+	// applied, CurrentTransform is then the world transform it will get
+	bool IsStale()const;
+	Matrix CurrentTransform()const;
+
+	GameObject *parent = nullptr;
+	std::vector<GameObject*> children;
+
+	// The local transform changed and transform hasn't caught up yet
+	bool dirty = false;
+
+	// Built by GetHull, again after UpdateAABB
+	ConvexHull hull;
+	bool hullDirty = true;
 
 
 public:
 	
+	// World transform, and the transform relative to the parent. They are the
+	// same for objects without a parent
 	Matrix transform;
+	Matrix localTransform;
 	Vec3 portalPosition;
 	Vec3 portalNormal;
 	Vec3 color;
@@ -26,22 +48,63 @@ public:
 	float nrVerts = 0.0f;
 	int cameraRotation = 0;	// 0, 90, 180, 270
 
+	// The world transform changed since SceneBuffer last packed the object
+	bool moved = true;
+
+
+	// Bounds of the model space vertices, and in world space. SetTransform
+	// updates the world bounds from the local ones, so they can be larger than
+	// the transformed vertices when rotated. UpdateAABB updates both after the
+	// vertices change and FitAABB makes the world bounds tight
+	Vec3 localMin;
+	Vec3 localMax;
+	Vec3 aabbMin;
+	Vec3 aabbMax;
+
+	// Model space vertex positions, one array per axis
+	std::vector<float> xs;
+	std::vector<float> ys;
+	std::vector<float> zs;
 
-	/*
-		Vec3 AABBmin;
-		Vec3 AABBmax;
-		Vec3 verts[];
-	*/
-	std::vector<float> values;
+	// nrVerts vertex numbers per face, a vertex shared by several faces is
+	// only stored once
+	std::vector<int> indices;
 	
 
 	GameObject();
 	~GameObject();
 
-	int NrValues();
+	// new and delete place the object in GameObjectPool
+	static void* operator new(size_t size);
+	static void operator delete(void *p);
+
+	// Stays safe to look up after the object is deleted
+	GameObjectPool::Handle GetHandle()const;
+
+	int NrPositions()const;
+	void UpdateAABB();
+	void FitAABB();
+
+	// Convex hull of the vertices for the GJK support function
+	ConvexHull& GetHull();
+
+	// SetTransform, Rotate and Orbit work on the local transform. An object
+	// without a parent gets its world transform right away, children get
+	// theirs from UpdateTransforms
 	void SetTransform(const Matrix &m);
 	void SetTransform(const Vec3 &pos, const float rot);
-	void SetAABB(const Vec3 &min, const Vec3 &max);
 	void Rotate(const Matrix &m);
 	void Orbit(const Vec3 &point, const Vec3 &axis, const float speed);
+
+	// What Rotate and Orbit do to a transform, rotation given as a matrix
+	static Matrix RotateMatrix(const Matrix &transform, const Matrix &rotation);
+	static Matrix OrbitMatrix(const Matrix &transform, const Vec3 &point, const Matrix &rotation);
+
+	// Attach to parent, or detach with nullptr, keeping the world transform
+	void SetParent(GameObject *parent);
+	GameObject* GetParent()const;
+
+	// Bring the world transforms below the objects up to date, only the
+	// subtrees that changed are recalculated
+	static void UpdateTransforms(const std::vector<GameObject*> &objects);
 };
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "gameObjectPool.h"
+#include "gameObject.h"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+
+typedef std::aligned_storage<sizeof(GameObject), alignof(GameObject)>::type PoolSlot;
+
+struct PoolBlock
+{
+	PoolSlot objects[GameObjectPool::BlockSize];
+
+	// Odd while the slot holds an object, bumped on new and on delete. Only
+	// changed under the lock, Get and GetHandle read them without it
+	std::atomic<uint32_t> generations[GameObjectPool::BlockSize];
+
+	PoolBlock()
+	{
+		for (int i = 0; i < GameObjectPool::BlockSize; i++)
+			this->generations[i].store(0, std::memory_order_relaxed);
+	}
+};
+
+static std::mutex mutex;
+
+// Only added to, Get and GetHandle read them without taking the lock
+static std::atomic<PoolBlock*> blocks[GameObjectPool::MaxBlocks];
+static std::atomic<int> nrBlocks(0);
+
+// Taken from the back, so a new block is used front to back
+static std::vector<uint32_t> freeSlots;
+
+
+// Index of the slot p points into, -1 when it isn't one of ours
+static int FindSlot(const void *p)
+{
+	const char *c = (const char*)p;
+	int count = nrBlocks.load(std::memory_order_acquire);
+	for (int b = 0; b < count; b++)
+	{
+		const char *start = (const char*)blocks[b].load(std::memory_order_relaxed)->objects;
+		if (c >= start && c < start + sizeof(PoolBlock::objects))
+			return b * GameObjectPool::BlockSize + int((c - start) / sizeof(PoolSlot));
+	}
+	return -1;
+}
+
+static PoolBlock* GetBlock(const uint32_t index)
+{
+	return blocks[index / GameObjectPool::BlockSize].load(std::memory_order_relaxed);
+}
+
+
+GameObjectPool::GameObjectPool()
+{}
+
+GameObjectPool::~GameObjectPool()
+{}
+
+
+void* GameObjectPool::Allocate(const size_t size)
+{
+	// Only whole GameObjects fit in a slot
+	if (size != sizeof(GameObject))
+		return ::operator new(size);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (freeSlots.empty())
+	{
+		int b = nrBlocks.load(std::memory_order_relaxed);
+		if (b == MaxBlocks)
+			throw std::bad_alloc();
+
+		PoolBlock *block = new PoolBlock;
+		for (int i = BlockSize - 1; i >= 0; i--)
+			freeSlots.push_back(b * BlockSize + i);
+
+		blocks[b].store(block, std::memory_order_relaxed);
+		nrBlocks.store(b + 1, std::memory_order_release);
+	}
+
+	uint32_t index = freeSlots.back();
+	freeSlots.pop_back();
+
+	PoolBlock *block = GetBlock(index);
+	std::atomic<uint32_t> &generation = block->generations[index % BlockSize];
+	generation.store(generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	return &block->objects[index % BlockSize];
+}
+
+void GameObjectPool::Free(void *p)
+{
+	if (p == nullptr)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	int index = FindSlot(p);
+	if (index < 0)
+	{
+		::operator delete(p);
+		return;
+	}
+
+	std::atomic<uint32_t> &generation = GetBlock(index)->generations[index % BlockSize];
+	generation.store(generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	freeSlots.push_back(index);
+}
+
+
+GameObjectPool::Handle GameObjectPool::GetHandle(const GameObject *go)
+{
+	Handle handle;
+	int index = FindSlot(go);
+	if (index < 0)
+		return handle;
+
+	handle.index = index;
+	handle.generation = GetBlock(index)->generations[index % BlockSize].load(std::memory_order_acquire);
+	return handle;
+}
+
+GameObject* GameObjectPool::Get(const Handle &handle)
+{
+	// Generation 0 is never given out, so a default handle finds nothing
+	if (handle.generation == 0 || handle.index / BlockSize >= (uint32_t)nrBlocks.load(std::memory_order_acquire))
+		return nullptr;
+
+	PoolBlock *block = GetBlock(handle.index);
+	if (block->generations[handle.index % BlockSize].load(std::memory_order_acquire) != handle.generation)
+		return nullptr;
+
+	return (GameObject*)&block->objects[handle.index % BlockSize];
+}
+
+
+void GameObjectPool::DestroyAll()
+{
+	std::vector<GameObject*> live;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		int count = nrBlocks.load(std::memory_order_relaxed);
+		for (int b = 0; b < count; b++)
+		{
+			PoolBlock *block = blocks[b].load(std::memory_order_relaxed);
+			for (int i = 0; i < BlockSize; i++)
+			{
+				if (block->generations[i].load(std::memory_order_relaxed) & 1)
+					live.push_back((GameObject*)&block->objects[i]);
+			}
+		}
+	}
+
+	// delete comes back through Free, so not under the lock. The destructors
+	// only unlink parents and children, the order doesn't matter
+	for (size_t i = 0; i < live.size(); i++)
+		delete live[i];
+}
+
+int GameObjectPool::NrObjects()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return nrBlocks.load(std::memory_order_relaxed) * BlockSize - (int)freeSlots.size();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class GameObject;
+
+
+// Storage for every GameObject, new and delete on a GameObject go through
+// here. Objects are placed next to each other in blocks that never move, so
+// pointers stay valid while other threads load more, and a freed slot is
+// given to the next object
+class GameObjectPool
+{
+public:
+
+	// Refers to one object, Get returns nullptr once it has been deleted even
+	// if the slot holds a new object
+	struct Handle
+	{
+		uint32_t index = 0;
+		uint32_t generation = 0;
+	};
+
+	static const int BlockSize = 256;
+	static const int MaxBlocks = 4096;
+
+
+	GameObjectPool();
+	~GameObjectPool();
+
+	// Used by GameObject's operator new and delete
+	static void* Allocate(const size_t size);
+	static void Free(void *p);
+
+	static Handle GetHandle(const GameObject *go);
+	static GameObject* Get(const Handle &handle);
+
+	// Delete every object, for when the scene is unloaded. Nothing may still
+	// be using them, or be creating new ones on another thread
+	static void DestroyAll();
+
+	static int NrObjects();
+};
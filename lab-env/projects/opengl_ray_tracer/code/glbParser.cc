@@ -0,0 +1,741 @@
+#include "glbParser.h"
+#include "mappedFile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+
+GlbParser::GlbParser()
+{}
+
+GlbParser::~GlbParser()
+{}
+
+
+// JSON
+// ------------------------------------------------------------------------
+// The JSON chunk is parsed into a flat list of nodes. Arrays and objects link
+// to their first child and every child to the next, object members also keep
+// their key. Strings point into the text and are not unescaped, glTF only
+// needs them for keys and enum-like values
+
+enum JsonType
+{
+	JsonNull,
+	JsonBool,
+	JsonNumber,
+	JsonString,
+	JsonArray,
+	JsonObject
+};
+
+struct JsonNode
+{
+	JsonType type = JsonNull;
+	double number = 0.0;
+
+	const char *string = nullptr;
+	size_t length = 0;
+
+	// Member name when the parent is an object
+	const char *key = nullptr;
+	size_t keyLength = 0;
+
+	int firstChild = -1;
+	int lastChild = -1;
+	int next = -1;
+};
+
+class Json
+{
+public:
+
+	// Text must be null terminated, node 0 is the root
+	bool Parse(const char *text, const size_t length)
+	{
+		this->nodes.clear();
+		this->nodes.push_back(JsonNode());
+		this->p = text;
+		this->end = text + length;
+
+		if (!this->ParseValue(0, 0))
+			return false;
+
+		this->SkipSpaces();
+		return this->p == this->end;
+	}
+
+	// -1 when the node is missing or has the wrong type
+	int Member(const int node, const char *key)const
+	{
+		if (node < 0 || this->nodes[node].type != JsonObject)
+			return -1;
+
+		size_t keyLength = strlen(key);
+		for (int child = this->nodes[node].firstChild; child >= 0; child = this->nodes[child].next)
+		{
+			const JsonNode &n = this->nodes[child];
+			if (n.keyLength == keyLength && memcmp(n.key, key, keyLength) == 0)
+				return child;
+		}
+		return -1;
+	}
+
+	int Element(const int node, const int index)const
+	{
+		if (node < 0 || index < 0 || this->nodes[node].type != JsonArray)
+			return -1;
+
+		int child = this->nodes[node].firstChild;
+		for (int i = 0; i < index && child >= 0; i++)
+			child = this->nodes[child].next;
+		return child;
+	}
+
+	double Number(const int node, const char *key, const double defaultValue)const
+	{
+		int member = this->Member(node, key);
+		if (member < 0 || this->nodes[member].type != JsonNumber)
+			return defaultValue;
+		return this->nodes[member].number;
+	}
+
+	int Int(const int node, const char *key, const int defaultValue)const
+	{
+		double d = this->Number(node, key, defaultValue);
+		if (d < -2147483648.0 || d > 2147483647.0 || d != (int)d)
+			return defaultValue;
+		return (int)d;
+	}
+
+	bool IsString(const int node, const char *value)const
+	{
+		if (node < 0 || this->nodes[node].type != JsonString)
+			return false;
+
+		size_t length = strlen(value);
+		return this->nodes[node].length == length && memcmp(this->nodes[node].string, value, length) == 0;
+	}
+
+	// Numbers of an array member, false if it isn't exactly count numbers
+	bool Numbers(const int node, const char *key, float *out, const int count)const
+	{
+		int array = this->Member(node, key);
+		if (array < 0 || this->nodes[array].type != JsonArray)
+			return false;
+
+		int i = 0;
+		for (int child = this->nodes[array].firstChild; child >= 0; child = this->nodes[child].next, i++)
+		{
+			if (i == count || this->nodes[child].type != JsonNumber)
+				return false;
+			out[i] = (float)this->nodes[child].number;
+		}
+		return i == count;
+	}
+
+	std::vector<JsonNode> nodes;
+
+private:
+
+	static const int MaxDepth = 64;
+
+	void SkipSpaces()
+	{
+		while (this->p < this->end && (*this->p == ' ' || *this->p == '\t' || *this->p == '\n' || *this->p == '\r'))
+			this->p++;
+	}
+
+	bool ParseString(const char *&string, size_t &length)
+	{
+		if (this->p >= this->end || *this->p != '"')
+			return false;
+
+		const char *start = ++this->p;
+		while (this->p < this->end && *this->p != '"')
+		{
+			if (*this->p == '\\')
+				this->p++;
+			this->p++;
+		}
+		if (this->p >= this->end)
+			return false;
+
+		string = start;
+		length = this->p - start;
+		this->p++;
+		return true;
+	}
+
+	bool ParseLiteral(const char *literal)
+	{
+		size_t length = strlen(literal);
+		if ((size_t)(this->end - this->p) < length || memcmp(this->p, literal, length) != 0)
+			return false;
+		this->p += length;
+		return true;
+	}
+
+	bool ParseValue(const int node, const int depth)
+	{
+		this->SkipSpaces();
+		if (this->p >= this->end || depth > MaxDepth)
+			return false;
+
+		char c = *this->p;
+		if (c == '{' || c == '[')
+		{
+			bool isObject = (c == '{');
+			char close = isObject ? '}' : ']';
+			this->nodes[node].type = isObject ? JsonObject : JsonArray;
+			this->p++;
+
+			this->SkipSpaces();
+			if (this->p < this->end && *this->p == close)
+			{
+				this->p++;
+				return true;
+			}
+
+			while (true)
+			{
+				int child = this->nodes.size();
+				this->nodes.push_back(JsonNode());
+
+				if (isObject)
+				{
+					this->SkipSpaces();
+					const char *key;
+					size_t keyLength;
+					if (!this->ParseString(key, keyLength))
+						return false;
+
+					this->SkipSpaces();
+					if (this->p >= this->end || *this->p != ':')
+						return false;
+					this->p++;
+
+					this->nodes[child].key = key;
+					this->nodes[child].keyLength = keyLength;
+				}
+
+				if (!this->ParseValue(child, depth + 1))
+					return false;
+
+				// Nodes may have moved while parsing the child
+				JsonNode &parent = this->nodes[node];
+				if (parent.lastChild < 0)
+					parent.firstChild = child;
+				else
+					this->nodes[parent.lastChild].next = child;
+				parent.lastChild = child;
+
+				this->SkipSpaces();
+				if (this->p < this->end && *this->p == ',')
+					this->p++;
+				else if (this->p < this->end && *this->p == close)
+				{
+					this->p++;
+					return true;
+				}
+				else
+					return false;
+			}
+		}
+
+		JsonNode &n = this->nodes[node];
+		if (c == '"')
+		{
+			n.type = JsonString;
+			return this->ParseString(n.string, n.length);
+		}
+		if (c == 't' || c == 'f')
+		{
+			n.type = JsonBool;
+			n.number = (c == 't') ? 1.0 : 0.0;
+			return this->ParseLiteral(c == 't' ? "true" : "false");
+		}
+		if (c == 'n')
+			return this->ParseLiteral("null");
+
+		char *numberEnd;
+		n.type = JsonNumber;
+		n.number = strtod(this->p, &numberEnd);
+		if (numberEnd == this->p || numberEnd > this->end)
+			return false;
+		this->p = numberEnd;
+		return true;
+	}
+
+	const char *p = nullptr;
+	const char *end = nullptr;
+};
+
+
+// glTF
+// ------------------------------------------------------------------------
+
+static const uint32_t GlbMagic = 0x46546C67;		// "glTF"
+static const uint32_t ChunkJson = 0x4E4F534A;		// "JSON"
+static const uint32_t ChunkBin = 0x004E4942;		// "BIN\0"
+
+static const int ComponentUnsignedByte = 5121;
+static const int ComponentUnsignedShort = 5123;
+static const int ComponentUnsignedInt = 5125;
+static const int ComponentFloat = 5126;
+
+static const int ModeTriangles = 4;
+
+// Deeper hierarchies are rejected to bound the recursion
+static const int MaxNodeDepth = 64;
+
+
+struct Glb
+{
+	const char *filename;
+
+	// Null terminated copy of the JSON chunk
+	std::string text;
+	Json json;
+
+	const unsigned char *bin = nullptr;
+	size_t binSize = 0;
+};
+
+// Elements of an accessor in the binary chunk
+struct Accessor
+{
+	const unsigned char *data = nullptr;
+	size_t stride = 0;
+	size_t count = 0;
+	int componentType = 0;
+};
+
+
+static uint32_t ReadUint(const char *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static bool ReadGlb(const MappedFile &file, Glb &glb)
+{
+	const char *data = file.Data();
+	size_t size = file.Size();
+
+	if (size < 20 || ReadUint(data) != GlbMagic || ReadUint(data + 4) != 2)
+	{
+		fprintf(stderr, "%s is not a glTF 2.0 binary file\n", glb.filename);
+		return false;
+	}
+
+	// The JSON chunk comes first, the binary chunk is optional
+	size_t jsonLength = ReadUint(data + 12);
+	if (ReadUint(data + 16) != ChunkJson || jsonLength > size - 20)
+	{
+		fprintf(stderr, "Invalid .glb file %s! Missing JSON chunk\n", glb.filename);
+		return false;
+	}
+
+	size_t offset = 20 + jsonLength;
+	if (size - offset >= 8 && ReadUint(data + offset + 4) == ChunkBin)
+	{
+		size_t binLength = ReadUint(data + offset);
+		if (binLength > size - offset - 8)
+		{
+			fprintf(stderr, "Invalid .glb file %s! The binary chunk is truncated\n", glb.filename);
+			return false;
+		}
+		glb.bin = (const unsigned char*)data + offset + 8;
+		glb.binSize = binLength;
+	}
+
+	glb.text.assign(data + 20, jsonLength);
+	if (!glb.json.Parse(glb.text.c_str(), glb.text.size()))
+	{
+		fprintf(stderr, "Invalid .glb file %s! Could not parse the JSON chunk\n", glb.filename);
+		return false;
+	}
+
+	return true;
+}
+
+static size_t ComponentSize(const int componentType)
+{
+	switch (componentType)
+	{
+		case ComponentUnsignedByte:
+			return 1;
+		case ComponentUnsignedShort:
+			return 2;
+		case ComponentUnsignedInt:
+		case ComponentFloat:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+// Find the accessor's elements in the binary chunk and check that they are
+// all inside its buffer view
+static bool GetAccessor(const Glb &glb, const int index, const char *type, Accessor &accessor)
+{
+	const Json &json = glb.json;
+	int a = json.Element(json.Member(0, "accessors"), index);
+	if (a < 0 || json.Member(a, "sparse") >= 0 || !json.IsString(json.Member(a, "type"), type))
+		return false;
+
+	int view = json.Element(json.Member(0, "bufferViews"), json.Int(a, "bufferView", -1));
+	if (view < 0 || json.Int(view, "buffer", -1) != 0)
+		return false;
+
+	int componentType = json.Int(a, "componentType", 0);
+	double elementSize = (double)ComponentSize(componentType) * (strcmp(type, "VEC3") == 0 ? 3 : 1);
+	if (elementSize == 0)
+		return false;
+
+	double count = json.Number(a, "count", -1.0);
+	double accessorOffset = json.Number(a, "byteOffset", 0.0);
+	double viewOffset = json.Number(view, "byteOffset", 0.0);
+	double viewLength = json.Number(view, "byteLength", -1.0);
+	double stride = json.Number(view, "byteStride", elementSize);
+
+	bool valid =
+		count >= 0 && accessorOffset >= 0 && viewOffset >= 0 && viewLength >= 0 && stride >= elementSize &&
+		viewOffset + viewLength <= (double)glb.binSize &&
+		(count == 0 || accessorOffset + stride * (count - 1) + elementSize <= viewLength);
+	if (!valid)
+		return false;
+
+	accessor.data = glb.bin + (size_t)viewOffset + (size_t)accessorOffset;
+	accessor.stride = (size_t)stride;
+	accessor.count = (size_t)count;
+	accessor.componentType = componentType;
+	return true;
+}
+
+static Matrix NodeTransform(const Json &json, const int node)
+{
+	float m[16];
+	if (json.Numbers(node, "matrix", m, 16))
+	{
+		// glTF stores the columns
+		return Matrix(m[0], m[4], m[8],  m[12],
+					  m[1], m[5], m[9],  m[13],
+					  m[2], m[6], m[10], m[14],
+					  m[3], m[7], m[11], m[15]);
+	}
+
+	float t[3] = { 0.0f, 0.0f, 0.0f };
+	float r[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float s[3] = { 1.0f, 1.0f, 1.0f };
+	json.Numbers(node, "translation", t, 3);
+	json.Numbers(node, "rotation", r, 4);
+	json.Numbers(node, "scale", s, 3);
+
+	// Translation * rotation * scale
+	Matrix rotation(Vec4(r[0], r[1], r[2], r[3]));
+	return Matrix(rotation.Get(0, 0) * s[0], rotation.Get(0, 1) * s[1], rotation.Get(0, 2) * s[2], t[0],
+				  rotation.Get(1, 0) * s[0], rotation.Get(1, 1) * s[1], rotation.Get(1, 2) * s[2], t[1],
+				  rotation.Get(2, 0) * s[0], rotation.Get(2, 1) * s[1], rotation.Get(2, 2) * s[2], t[2],
+				  0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+static Vec3 MaterialColor(const Json &json, const int primitive)
+{
+	int material = json.Element(json.Member(0, "materials"), json.Int(primitive, "material", -1));
+	float color[4];
+	if (json.Numbers(json.Member(material, "pbrMetallicRoughness"), "baseColorFactor", color, 4))
+		return Vec3(color[0], color[1], color[2]);
+
+	return Vec3(1.0f, 1.0f, 1.0f);
+}
+
+// Append the primitive's positions and triangles to go, with the positions
+// transformed by bake if there is one. Primitives that aren't triangles are
+// skipped
+static bool AddPrimitive(const Glb &glb, const int primitive, const Matrix *bake, GameObject *go)
+{
+	const Json &json = glb.json;
+
+	if (json.Int(primitive, "mode", ModeTriangles) != ModeTriangles)
+	{
+		fprintf(stderr, "Skipping a primitive in %s, only triangles are supported\n", glb.filename);
+		return true;
+	}
+
+	Accessor positions;
+	int positionIndex = json.Int(json.Member(primitive, "attributes"), "POSITION", -1);
+	if (!GetAccessor(glb, positionIndex, "VEC3", positions) || positions.componentType != ComponentFloat)
+	{
+		fprintf(stderr, "Invalid .glb file %s! Positions need to be floats inside the binary chunk\n", glb.filename);
+		return false;
+	}
+
+	Accessor indices;
+	int indicesIndex = json.Int(primitive, "indices", -1);
+	bool indexed = (indicesIndex >= 0);
+	if (indexed && (!GetAccessor(glb, indicesIndex, "SCALAR", indices) || indices.componentType == ComponentFloat))
+	{
+		fprintf(stderr, "Invalid .glb file %s! Indices need to be unsigned integers inside the binary chunk\n", glb.filename);
+		return false;
+	}
+
+	size_t nrCorners = indexed ? indices.count : positions.count;
+	if (nrCorners % 3 != 0)
+	{
+		fprintf(stderr, "Invalid .glb file %s! A triangle primitive has %zu corners\n", glb.filename, nrCorners);
+		return false;
+	}
+
+
+	// Positions, tightly packed ones in one copy
+	std::vector<float> xyz(positions.count * 3);
+	if (positions.stride == 12)
+		memcpy(xyz.data(), positions.data, positions.count * 12);
+	else
+	{
+		for (size_t i = 0; i < positions.count; i++)
+			memcpy(&xyz[i * 3], positions.data + i * positions.stride, 12);
+	}
+
+	if (bake != nullptr && positions.count > 0)
+		bake->TransformPoints(xyz.data(), xyz.data(), positions.count);
+
+	size_t firstPosition = go->xs.size();
+	go->xs.resize(firstPosition + positions.count);
+	go->ys.resize(firstPosition + positions.count);
+	go->zs.resize(firstPosition + positions.count);
+	for (size_t i = 0; i < positions.count; i++)
+	{
+		go->xs[firstPosition + i] = xyz[i * 3 + 0];
+		go->ys[firstPosition + i] = xyz[i * 3 + 1];
+		go->zs[firstPosition + i] = xyz[i * 3 + 2];
+	}
+
+
+	// Corners as numbers into the object's positions
+	size_t firstIndex = go->indices.size();
+	go->indices.resize(firstIndex + nrCorners);
+	int *index = &go->indices[firstIndex];
+
+	for (size_t i = 0; i < nrCorners; i++)
+	{
+		uint32_t value = i;
+		if (indexed)
+		{
+			const unsigned char *p = indices.data + i * indices.stride;
+			if (indices.componentType == ComponentUnsignedByte)
+				value = *p;
+			else if (indices.componentType == ComponentUnsignedShort)
+			{
+				uint16_t v;
+				memcpy(&v, p, sizeof(v));
+				value = v;
+			}
+			else
+				memcpy(&value, p, sizeof(value));
+		}
+
+		if (value >= positions.count)
+		{
+			fprintf(stderr, "Invalid .glb file %s! Index %u refers to a missing vertex\n", glb.filename, value);
+			return false;
+		}
+		index[i] = (int)(firstPosition + value);
+	}
+
+	go->nrVerts = 3;
+	return true;
+}
+
+// Call visit(node, world transform) for every node with a mesh in the default
+// scene, parents before children. index is the glTF node index, and a node
+// may only be reached once since glTF gives every node at most one parent,
+// which also rules out cycles
+static bool VisitNodes(const Glb &glb, const int index, const Matrix &parent, const int depth,
+					   std::vector<bool> &visited, const std::function<bool(int, const Matrix&)> &visit)
+{
+	const Json &json = glb.json;
+	int node = json.Element(json.Member(0, "nodes"), index);
+	if (node < 0 || depth > MaxNodeDepth || visited[index])
+	{
+		fprintf(stderr, "Invalid .glb file %s! Broken node hierarchy\n", glb.filename);
+		return false;
+	}
+	visited[index] = true;
+
+	Matrix world = parent * NodeTransform(json, node);
+	if (json.Member(node, "mesh") >= 0 && !visit(node, world))
+		return false;
+
+	int children = json.Member(node, "children");
+	for (int child = (children >= 0) ? json.nodes[children].firstChild : -1; child >= 0; child = json.nodes[child].next)
+	{
+		if (json.nodes[child].type != JsonNumber)
+		{
+			fprintf(stderr, "Invalid .glb file %s! Child that isn't a node index\n", glb.filename);
+			return false;
+		}
+
+		if (!VisitNodes(glb, (int)json.nodes[child].number, world, depth + 1, visited, visit))
+			return false;
+	}
+
+	return true;
+}
+
+static bool VisitScene(const Glb &glb, const std::function<bool(int, const Matrix&)> &visit)
+{
+	const Json &json = glb.json;
+	int nodes = json.Member(0, "nodes");
+	int nrNodes = 0;
+	for (int node = (nodes >= 0) ? json.nodes[nodes].firstChild : -1; node >= 0; node = json.nodes[node].next)
+		nrNodes++;
+
+	// The roots of the default scene, or every node without a parent when the
+	// file has no scenes
+	std::vector<int> roots;
+	int scene = json.Element(json.Member(0, "scenes"), json.Int(0, "scene", 0));
+	if (scene >= 0)
+	{
+		int sceneNodes = json.Member(scene, "nodes");
+		for (int root = (sceneNodes >= 0) ? json.nodes[sceneNodes].firstChild : -1; root >= 0; root = json.nodes[root].next)
+		{
+			if (json.nodes[root].type != JsonNumber)
+			{
+				fprintf(stderr, "Invalid .glb file %s! Scene root that isn't a node index\n", glb.filename);
+				return false;
+			}
+			roots.push_back((int)json.nodes[root].number);
+		}
+	}
+	else
+	{
+		std::vector<bool> isChild(nrNodes, false);
+		for (int node = (nodes >= 0) ? json.nodes[nodes].firstChild : -1; node >= 0; node = json.nodes[node].next)
+		{
+			int children = json.Member(node, "children");
+			for (int child = (children >= 0) ? json.nodes[children].firstChild : -1; child >= 0; child = json.nodes[child].next)
+			{
+				// Bad entries are reported when the parent is visited
+				int index = (int)json.nodes[child].number;
+				if (json.nodes[child].type == JsonNumber && index >= 0 && index < nrNodes)
+					isChild[index] = true;
+			}
+		}
+
+		for (int i = 0; i < nrNodes; i++)
+		{
+			if (!isChild[i])
+				roots.push_back(i);
+		}
+	}
+
+	std::vector<bool> visited(nrNodes, false);
+	for (size_t i = 0; i < roots.size(); i++)
+	{
+		if (!VisitNodes(glb, roots[i], Matrix(), 0, visited, visit))
+			return false;
+	}
+
+	return true;
+}
+
+
+GameObject* GlbParser::LoadMesh(const char *filename)
+{
+	MappedFile file;
+	if (!file.Open(filename))
+	{
+		fprintf(stderr, "Could not read file %s\n", filename);
+		return nullptr;
+	}
+
+	Glb glb;
+	glb.filename = filename;
+	if (!ReadGlb(file, glb))
+		return nullptr;
+
+	const Json &json = glb.json;
+	GameObject *go = new GameObject();
+
+	bool ok = VisitScene(glb, [&](int node, const Matrix &world)
+	{
+		int mesh = json.Element(json.Member(0, "meshes"), json.Int(node, "mesh", -1));
+		int primitives = json.Member(mesh, "primitives");
+		for (int p = (primitives >= 0) ? json.nodes[primitives].firstChild : -1; p >= 0; p = json.nodes[p].next)
+		{
+			if (!AddPrimitive(glb, p, &world, go))
+				return false;
+		}
+		return true;
+	});
+
+	if (!ok)
+	{
+		delete go;
+		return nullptr;
+	}
+
+	// The vertices are already in place, the transform stays identity
+	go->UpdateAABB();
+	return go;
+}
+
+void GlbParser::LoadScene(const char *filename, std::vector<GameObject*> &objectsInScene)
+{
+	fprintf(stderr, "Reading file %s\n", filename);
+
+	MappedFile file;
+	if (!file.Open(filename))
+	{
+		fprintf(stderr, "Could not read file %s\n", filename);
+		return;
+	}
+
+	Glb glb;
+	glb.filename = filename;
+	if (!ReadGlb(file, glb))
+		return;
+
+	const Json &json = glb.json;
+	std::vector<GameObject*> objects;
+
+	bool ok = VisitScene(glb, [&](int node, const Matrix &world)
+	{
+		int mesh = json.Element(json.Member(0, "meshes"), json.Int(node, "mesh", -1));
+		int primitives = json.Member(mesh, "primitives");
+		for (int p = (primitives >= 0) ? json.nodes[primitives].firstChild : -1; p >= 0; p = json.nodes[p].next)
+		{
+			GameObject *go = new GameObject();
+			objects.push_back(go);
+
+			if (!AddPrimitive(glb, p, nullptr, go))
+				return false;
+
+			go->color = MaterialColor(json, p);
+			go->UpdateAABB();
+			go->SetTransform(world);
+		}
+		return true;
+	});
+
+	// Skipped primitives leave empty objects behind
+	std::vector<GameObject*> kept;
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		if (ok && !objects[i]->indices.empty())
+			kept.push_back(objects[i]);
+		else
+			delete objects[i];
+	}
+
+	objectsInScene.insert(objectsInScene.end(), kept.begin(), kept.end());
+
+	fprintf(stderr, "Done parsing file. Created %li objects\n", kept.size());
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include "gameObject.h"
+
+
+// Binary glTF 2.0 (.glb) meshes. Positions and indices are read straight from
+// the binary chunk, only the small JSON chunk describing it is parsed.
+// Triangles only, no textures, normals or animation
+class GlbParser
+{
+public:
+	GlbParser();
+	~GlbParser();
+
+	// Every mesh in the default scene as one object, the node transforms are
+	// applied to the vertices
+	static GameObject* LoadMesh(const char *filename);
+
+	// One object per mesh primitive in the default scene, with the node's
+	// world transform and the material's base color
+	static void LoadScene(const char *filename, std::vector<GameObject*> &objectsInScene);
+};
@@ -0,0 +1,132 @@
+#include "goldenImages.h"
+#include "sceneBuffer.h"
+#include "cpuTracer.h"
+#include "camera.h"
+#include "image.h"
+
+#include <cstdio>
+
+
+// Render a pose, rounded to 8 bits like the stored references
+static void RenderPose(const GoldenImages::Pose &pose, CpuTracer &tracer, ThreadPool &pool, Image &image)
+{
+	Camera camera;
+	camera.position = pose.position;
+	camera.hAngle = pose.hAngle;
+	camera.vAngle = pose.vAngle;
+	camera.Update(0.0f);
+
+	tracer.eye = camera.position;
+	camera.GetCornerRays(tracer.ray00, tracer.ray10, tracer.ray01, tracer.ray11);
+
+	image.Resize(GoldenImages::Width, GoldenImages::Height);
+	tracer.Render(image.width, image.height, image.pixels.data(), pool);
+	image.Quantize();
+}
+
+
+GoldenImages::GoldenImages()
+{}
+
+GoldenImages::~GoldenImages()
+{}
+
+
+std::vector<GoldenImages::Pose> GoldenImages::GetPoses()
+{
+	std::vector<Pose> poses;
+
+	// Start view, the 4D cube with its four portals
+	poses.push_back({ "cube_front", Vec3(0.0f, 1.5f, 3.5f), 0.0f, -20.0f });
+	poses.push_back({ "cube_side", Vec3(-3.5f, 1.5f, 0.0f), -90.0f, -10.0f });
+
+	// Left arch, both corner triangles of the portal
+	poses.push_back({ "left_arch", Vec3(-5.0f, 1.5f, 4.0f), 0.0f, -5.0f });
+
+	// Front arch into the corridor below the scene
+	poses.push_back({ "front_arch", Vec3(0.0f, 1.5f, 11.0f), 0.0f, -5.0f });
+
+	// Right arch, the mirror at the end of the corridor (rot180)
+	poses.push_back({ "mirror", Vec3(4.0f, 1.5f, 0.0f), 270.0f, -5.0f });
+
+	// Inside the corridor, the loop portal (rot270)
+	poses.push_back({ "loop", Vec3(-54.0f, -1.5f, 2.0f), 0.0f, 0.0f });
+
+	return poses;
+}
+
+bool GoldenImages::Check(const std::vector<GameObject*> &staticGO, const std::vector<GameObject*> &dynamicGO,
+						 const std::string &dir, const float minPSNR, ThreadPool &pool)
+{
+	std::vector<float> staticBuffer, dynamicBuffer;
+	SceneBuffer::Pack(staticGO, staticBuffer);
+	SceneBuffer::Pack(dynamicGO, dynamicBuffer);
+
+	CpuTracer tracer;
+	tracer.SetScene(staticBuffer.data(), dynamicBuffer.data());
+
+	std::vector<Pose> poses = GetPoses();
+	int failed = 0;
+
+	for (unsigned int i = 0; i < poses.size(); i++)
+	{
+		std::string reference = dir + "/" + poses[i].name + ".ppm";
+
+		Image expected, image;
+		if (!expected.ReadPPM(reference.c_str()))
+		{
+			failed++;
+			continue;
+		}
+
+		RenderPose(poses[i], tracer, pool, image);
+
+		float psnr = Image::PSNR(image, expected);
+		bool pass = (expected.width == image.width && expected.height == image.height && psnr >= minPSNR);
+		printf("%-12s %6.2f dB  %s\n", poses[i].name, psnr, pass ? "ok" : "FAILED");
+
+		if (!pass)
+		{
+			std::string diffName = dir + "/" + poses[i].name + "_diff.ppm";
+			Image diff;
+			Image::Difference(image, expected, 4.0f, diff);
+			diff.WritePPM(diffName.c_str());
+
+			std::string outName = dir + "/" + poses[i].name + "_out.ppm";
+			image.WritePPM(outName.c_str());
+
+			failed++;
+		}
+	}
+
+	printf("%i of %i golden images passed (min %.1f dB)\n", int(poses.size()) - failed, int(poses.size()), minPSNR);
+	return failed == 0;
+}
+
+bool GoldenImages::Update(const std::vector<GameObject*> &staticGO, const std::vector<GameObject*> &dynamicGO,
+						  const std::string &dir, ThreadPool &pool)
+{
+	std::vector<float> staticBuffer, dynamicBuffer;
+	SceneBuffer::Pack(staticGO, staticBuffer);
+	SceneBuffer::Pack(dynamicGO, dynamicBuffer);
+
+	CpuTracer tracer;
+	tracer.SetScene(staticBuffer.data(), dynamicBuffer.data());
+
+	std::vector<Pose> poses = GetPoses();
+	bool ok = true;
+
+	for (unsigned int i = 0; i < poses.size(); i++)
+	{
+		Image image;
+		RenderPose(poses[i], tracer, pool, image);
+
+		std::string name = dir + "/" + poses[i].name + ".ppm";
+		if (image.WritePPM(name.c_str()))
+			printf("Wrote %s\n", name.c_str());
+		else
+			ok = false;
+	}
+
+	return ok;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "mathVec3.h"
+#include "gameObject.h"
+#include "threadPool.h"
+
+
+// Renders fixed camera poses with the CPU tracer and compares them against
+// reference images, so changes to the tracer can be checked for visual
+// regressions. The poses look through every kind of portal in the scene
+class GoldenImages
+{
+public:
+
+	static const int Width = 256;
+	static const int Height = 192;
+
+	struct Pose
+	{
+		const char *name;
+		Vec3 position;
+		float hAngle;
+		float vAngle;
+	};
+
+
+	GoldenImages();
+	~GoldenImages();
+
+	static std::vector<Pose> GetPoses();
+
+	// Compare every pose against <dir>/<name>.ppm and write <name>_diff.ppm
+	// for the ones below minPSNR. Returns true if all poses pass
+	static bool Check(const std::vector<GameObject*> &staticGO, const std::vector<GameObject*> &dynamicGO,
+					  const std::string &dir, const float minPSNR, ThreadPool &pool);
+
+	// Write new reference images to dir
+	static bool Update(const std::vector<GameObject*> &staticGO, const std::vector<GameObject*> &dynamicGO,
+					   const std::string &dir, ThreadPool &pool);
+};
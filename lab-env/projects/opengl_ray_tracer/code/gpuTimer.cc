@@ -0,0 +1,83 @@
+#include "gpuTimer.h"
+
+
+GpuTimer::GpuTimer()
+{
+	for (int i = 0; i < NrQueries; i++)
+	{
+		this->queries[i] = 0;
+		this->frames[i] = -1;
+		this->pending[i] = false;
+	}
+}
+
+GpuTimer::~GpuTimer()
+{}
+
+
+void GpuTimer::Init()
+{
+	glGenQueries(NrQueries, this->queries);
+}
+
+void GpuTimer::Release()
+{
+	// Names that are 0 or already deleted are ignored
+	glDeleteQueries(NrQueries, this->queries);
+	for (int i = 0; i < NrQueries; i++)
+	{
+		this->queries[i] = 0;
+		this->pending[i] = false;
+	}
+	this->active = false;
+}
+
+void GpuTimer::Begin(const long long frame)
+{
+	// Every query is still waiting for the GPU, skip timing this frame
+	if (this->pending[this->current])
+		return;
+
+	glBeginQuery(GL_TIME_ELAPSED, this->queries[this->current]);
+	this->frames[this->current] = frame;
+	this->active = true;
+}
+
+void GpuTimer::End()
+{
+	if (!this->active)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	this->active = false;
+	this->pending[this->current] = true;
+	this->current = (this->current + 1) % NrQueries;
+}
+
+bool GpuTimer::Poll(float &ms, long long &frame)
+{
+	// The oldest query in flight is the one that will be reused next
+	int oldest = this->current;
+	for (int i = 0; i < NrQueries; i++)
+	{
+		if (this->pending[oldest])
+			break;
+		oldest = (oldest + 1) % NrQueries;
+	}
+
+	if (!this->pending[oldest])
+		return false;
+
+	GLint available = 0;
+	glGetQueryObjectiv(this->queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(this->queries[oldest], GL_QUERY_RESULT, &nanoseconds);
+	this->pending[oldest] = false;
+
+	ms = float(nanoseconds / 1000000.0);
+	frame = this->frames[oldest];
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef GL_INCLUDED
+#define GL_INCLUDED
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#endif
+
+
+// Measures GPU time with GL_TIME_ELAPSED queries. Several queries are kept
+// in flight so reading a result never stalls the pipeline, which means the
+// times arrive a few frames after they were measured.
+class GpuTimer
+{
+public:
+
+	static const int NrQueries = 4;
+
+	GpuTimer();
+	~GpuTimer();
+
+	void Init();
+	// Delete the queries, while the context is still current
+	void Release();
+	// Start timing the given frame, its number comes back with the result
+	void Begin(const long long frame);
+	void End();
+
+	// Returns true and the time in ms and the frame it belongs to if the
+	// oldest query has finished
+	bool Poll(float &ms, long long &frame);
+
+private:
+
+	GLuint queries[NrQueries];
+	long long frames[NrQueries];
+	bool pending[NrQueries];
+	int current = 0;
+	bool active = false;
+};
@@ -0,0 +1,129 @@
+#include "image.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+Image::Image()
+{}
+
+Image::Image(const int width, const int height)
+{
+	this->Resize(width, height);
+}
+
+Image::~Image()
+{}
+
+
+void Image::Resize(const int width, const int height)
+{
+	this->width = width;
+	this->height = height;
+	this->pixels.assign(width * height * 3, 0.0f);
+}
+
+bool Image::WritePPM(const char *filename)const
+{
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not write image to %s\n", filename);
+		return false;
+	}
+
+	fprintf(file, "P6\n%i %i\n255\n", this->width, this->height);
+
+	// PPM starts at the top row
+	std::vector<unsigned char> row(this->width * 3);
+	for (int y = this->height - 1; y >= 0; y--)
+	{
+		const float *src = &this->pixels[y * this->width * 3];
+		for (int i = 0; i < this->width * 3; i++)
+			row[i] = (unsigned char)(std::min(std::max(src[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+
+		fwrite(row.data(), 1, row.size(), file);
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool Image::ReadPPM(const char *filename)
+{
+	FILE *file = fopen(filename, "rb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not open image %s\n", filename);
+		return false;
+	}
+
+	int width, height, maxValue;
+	if (fscanf(file, "P6 %i %i %i", &width, &height, &maxValue) != 3 || maxValue != 255 ||
+		width <= 0 || height <= 0 || fgetc(file) == EOF)
+	{
+		fprintf(stderr, "%s is not an 8-bit binary PPM\n", filename);
+		fclose(file);
+		return false;
+	}
+
+	this->Resize(width, height);
+
+	std::vector<unsigned char> row(width * 3);
+	for (int y = height - 1; y >= 0; y--)
+	{
+		if (fread(row.data(), 1, row.size(), file) != row.size())
+		{
+			fprintf(stderr, "%s is truncated\n", filename);
+			fclose(file);
+			return false;
+		}
+
+		float *dst = &this->pixels[y * width * 3];
+		for (int i = 0; i < width * 3; i++)
+			dst[i] = row[i] / 255.0f;
+	}
+
+	fclose(file);
+	return true;
+}
+
+void Image::Quantize()
+{
+	for (unsigned int i = 0; i < this->pixels.size(); i++)
+	{
+		float value = std::min(std::max(this->pixels[i], 0.0f), 1.0f);
+		this->pixels[i] = (unsigned char)(value * 255.0f + 0.5f) / 255.0f;
+	}
+}
+
+float Image::PSNR(const Image &a, const Image &b)
+{
+	if (a.width != b.width || a.height != b.height)
+		return 0.0f;
+
+	double sum = 0.0;
+	for (unsigned int i = 0; i < a.pixels.size(); i++)
+	{
+		double diff = a.pixels[i] - b.pixels[i];
+		sum += diff * diff;
+	}
+
+	if (sum == 0.0)
+		return std::numeric_limits<float>::infinity();
+
+	double mse = sum / a.pixels.size();
+	return float(10.0 * std::log10(1.0 / mse));
+}
+
+void Image::Difference(const Image &a, const Image &b, const float scale, Image &out)
+{
+	out.Resize(a.width, a.height);
+	if (a.width != b.width || a.height != b.height)
+		return;
+
+	for (unsigned int i = 0; i < a.pixels.size(); i++)
+		out.pixels[i] = std::fabs(a.pixels[i] - b.pixels[i]) * scale;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+
+// RGB float image, rows from the bottom up like an OpenGL texture
+class Image
+{
+public:
+
+	int width = 0;
+	int height = 0;
+	std::vector<float> pixels;
+
+
+	Image();
+	Image(const int width, const int height);
+	~Image();
+
+	void Resize(const int width, const int height);
+
+	// Binary 8-bit PPM, values are clamped to [0,1]
+	bool WritePPM(const char *filename)const;
+	bool ReadPPM(const char *filename);
+
+	// Rounded to what WritePPM stores, so a fresh render compares exactly
+	// against a saved one
+	void Quantize();
+
+	// Peak signal-to-noise ratio in dB, infinity for identical images
+	static float PSNR(const Image &a, const Image &b);
+
+	// Absolute difference per channel, scaled up so small errors are visible
+	static void Difference(const Image &a, const Image &b, const float scale, Image &out);
+};
@@ -25,13 +25,8 @@ public:
 		// Check for collision between each object and the camera
 		for (unsigned int i = 0; i < gameObjects.size(); i++)
 		{
-			Vec3 aabbMin = Vec3(gameObjects[i]->values[0],
-								gameObjects[i]->values[1],
-								gameObjects[i]->values[2]);
-
-			Vec3 aabbMax = Vec3(gameObjects[i]->values[3],
-								gameObjects[i]->values[4],
-								gameObjects[i]->values[5]);
+			const Vec3 &aabbMin = gameObjects[i]->aabbMin;
+			const Vec3 &aabbMax = gameObjects[i]->aabbMax;
 
 				
 			if (camMin.x > aabbMax.x ||
@@ -9,11 +9,15 @@ int
 main(int argc, const char** argv)
 {
 	Example::ExampleApp app;
+	if (!app.ParseArguments(argc, argv))
+		return 1;
+
 	if (app.Open())
 	{
 		app.Run();
 		app.Close();
 	}
 	app.Exit();
-	
+
+	return app.ExitCode();
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+MappedFile::MappedFile()
+{}
+
+MappedFile::~MappedFile()
+{
+	this->Close();
+}
+
+bool MappedFile::Open(const char *filename)
+{
+	this->Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	this->file = file;
+	this->size = (size_t)size.QuadPart;
+
+	// Empty files can't be mapped, they are open with no data
+	if (this->size == 0)
+		return true;
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		this->Close();
+		return false;
+	}
+	this->mapping = mapping;
+
+	this->data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (this->data == nullptr)
+	{
+		this->Close();
+		return false;
+	}
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	this->size = (size_t)info.st_size;
+
+	// Empty files can't be mapped, they are open with no data
+	if (this->size == 0)
+	{
+		close(fd);
+		return true;
+	}
+
+	// The whole file is read, so fault it all in with the mapping
+	int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+	flags |= MAP_POPULATE;
+#endif
+	void *p = mmap(nullptr, this->size, PROT_READ, flags, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+	{
+		this->size = 0;
+		return false;
+	}
+
+	this->data = (const char*)p;
+#endif
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (this->data != nullptr)
+		UnmapViewOfFile(this->data);
+	if (this->mapping != nullptr)
+		CloseHandle((HANDLE)this->mapping);
+	if (this->file != nullptr)
+		CloseHandle((HANDLE)this->file);
+	this->mapping = nullptr;
+	this->file = nullptr;
+#else
+	if (this->data != nullptr)
+		munmap((void*)this->data, this->size);
+#endif
+
+	this->data = nullptr;
+	this->size = 0;
+}
+
+const char* MappedFile::Data()const
+{
+	return this->data;
+}
+
+size_t MappedFile::Size()const
+{
+	return this->size;
+}
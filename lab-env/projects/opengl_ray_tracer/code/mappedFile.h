@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+
+// Read-only view of a whole file mapped into memory, the data is not null
+// terminated
+class MappedFile
+{
+private:
+
+	const char *data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	void *file = nullptr;
+	void *mapping = nullptr;
+#endif
+
+	MappedFile(const MappedFile&);
+	void operator=(const MappedFile&);
+
+
+public:
+
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const char *filename);
+	void Close();
+
+	const char* Data()const;
+	size_t Size()const;
+};
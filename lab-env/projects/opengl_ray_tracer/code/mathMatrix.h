@@ -1,19 +1,27 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 
+#include "mathSimd.h"
 #include "mathVec3.h"
 #include "mathVec4.h"
 
 #define PI 3.14159265359f
 
 
+#if MATH_SSE
+// Lanes x, y, z, w of the result taken from lanes of v
+#define MATRIX_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x))
+#endif
 
-class Matrix
+
+// Row-major, each row is 16 byte aligned and loads as one SIMD register
+class alignas(16) Matrix
 {
 private:
 
-	float m[16] = 
+	alignas(16) float m[16] = 
 	{
 		1, 0, 0, 0,
 		0, 1, 0, 0,
@@ -21,13 +29,60 @@ private:
 		0, 0, 0, 1
 	};
 
+	Simd::Float4 Row(const int row)const
+	{
+		return Simd::Load(this->m + row * 4);
+	}
+
+	void SetRow(const int row, const Simd::Float4 v)
+	{
+		Simd::Store(this->m + row * 4, v);
+	}
+
+#if MATH_SSE
+	// 2x2 matrices stored as (m00, m01, m10, m11)
+	// A * B
+	static __m128 Mat2Mul(const __m128 a, const __m128 b)
+	{
+		return _mm_add_ps(_mm_mul_ps(a, MATRIX_SWIZZLE(b, 0, 3, 0, 3)),
+						  _mm_mul_ps(MATRIX_SWIZZLE(a, 1, 0, 3, 2), MATRIX_SWIZZLE(b, 2, 1, 2, 1)));
+	}
+
+	// adj(A) * B
+	static __m128 Mat2AdjMul(const __m128 a, const __m128 b)
+	{
+		return _mm_sub_ps(_mm_mul_ps(MATRIX_SWIZZLE(a, 3, 3, 0, 0), b),
+						  _mm_mul_ps(MATRIX_SWIZZLE(a, 1, 1, 2, 2), MATRIX_SWIZZLE(b, 2, 3, 0, 1)));
+	}
+
+	// A * adj(B)
+	static __m128 Mat2MulAdj(const __m128 a, const __m128 b)
+	{
+		return _mm_sub_ps(_mm_mul_ps(a, MATRIX_SWIZZLE(b, 3, 0, 3, 0)),
+						  _mm_mul_ps(MATRIX_SWIZZLE(a, 1, 0, 3, 2), MATRIX_SWIZZLE(b, 2, 1, 2, 1)));
+	}
+#endif
+
 
 public:
 
 	// Construction
 	// ------------------------------------------------------------------------	
 	// Identity
-	Matrix()
+	constexpr Matrix()
+	{
+
+	}
+
+	// Row by row
+	constexpr Matrix(const float m0,  const float m1,  const float m2,  const float m3,
+					 const float m4,  const float m5,  const float m6,  const float m7,
+					 const float m8,  const float m9,  const float m10, const float m11,
+					 const float m12, const float m13, const float m14, const float m15) :
+		m{m0,  m1,  m2,  m3,
+		  m4,  m5,  m6,  m7,
+		  m8,  m9,  m10, m11,
+		  m12, m13, m14, m15}
 	{
 
 	}
@@ -113,6 +168,16 @@ public:
 		this->m[15] = 1.0f;
 	}
 
+	// Rotation about the y-axis by a multiple of 90 degrees, exact and
+	// without any trig so constant rotations fold at compile time
+	static constexpr Matrix RotationY(const int quarterTurns)
+	{
+		return (quarterTurns & 3) == 0 ? Matrix() :
+			   (quarterTurns & 3) == 1 ? Matrix( 0, 0, 1, 0,   0, 1, 0, 0,  -1, 0, 0, 0,   0, 0, 0, 1) :
+			   (quarterTurns & 3) == 2 ? Matrix(-1, 0, 0, 0,   0, 1, 0, 0,   0, 0,-1, 0,   0, 0, 0, 1) :
+										 Matrix( 0, 0,-1, 0,   0, 1, 0, 0,   1, 0, 0, 0,   0, 0, 0, 1);
+	}
+
 	// From quaternion
 	Matrix(const Vec4 &q)
 	{
@@ -138,7 +203,7 @@ public:
 
 	// Access
 	// ------------------------------------------------------------------------
-	float Get(const int row, const int col)const
+	constexpr float Get(const int row, const int col)const
 	{
 		return this->m[row * 4 + col];
 	}
@@ -148,7 +213,7 @@ public:
 		return this->m[i];
 	}
 
-	const float& operator[](const int i)const
+	constexpr const float& operator[](const int i)const
 	{
 		return this->m[i];
 	}
@@ -246,73 +311,202 @@ public:
 
 	// Multiplication
 	// ------------------------------------------------------------------------
+	// Each row of the result is the rows of m weighted by this row
 	Matrix operator*(const Matrix &m)const
 	{
 		Matrix newMatrix;
 
+		Simd::Float4 row0 = m.Row(0);
+		Simd::Float4 row1 = m.Row(1);
+		Simd::Float4 row2 = m.Row(2);
+		Simd::Float4 row3 = m.Row(3);
+
 		for (int row = 0; row < 4; row++)
 		{
-			for (int col = 0; col < 4; col++)
-			{
-				float sum = 0;
-				for (int inner = 0; inner < 4; inner++)
-				{
-					sum += this->m[row * 4 + inner] * m.m[inner * 4 + col];
-				}
-				newMatrix.m[row * 4 + col] = sum;
-			}
+			const float *r = this->m + row * 4;
+
+			// Summed from 0 and in the same order as the scalar loop was
+			Simd::Float4 sum = Simd::Zero();
+			sum = Simd::Add(sum, Simd::Mul(Simd::Splat(r[0]), row0));
+			sum = Simd::Add(sum, Simd::Mul(Simd::Splat(r[1]), row1));
+			sum = Simd::Add(sum, Simd::Mul(Simd::Splat(r[2]), row2));
+			sum = Simd::Add(sum, Simd::Mul(Simd::Splat(r[3]), row3));
+			newMatrix.SetRow(row, sum);
 		}
 
 		return newMatrix;
 	}
 
+	// Multiply every row with v and transpose the products, adding the
+	// columns then gives all four dot products summed x, y, z, w
 	Vec4 operator*(const Vec4 &v)const
 	{
-		Vec4 newVector;
+		Simd::Float4 vec = v.Load();
 
-		newVector.x =	this->m[0] * v.x +
-						this->m[1] * v.y +
-						this->m[2] * v.z +
-						this->m[3] * v.w;
+		Simd::Float4 p0 = Simd::Mul(this->Row(0), vec);
+		Simd::Float4 p1 = Simd::Mul(this->Row(1), vec);
+		Simd::Float4 p2 = Simd::Mul(this->Row(2), vec);
+		Simd::Float4 p3 = Simd::Mul(this->Row(3), vec);
+		Simd::Transpose(p0, p1, p2, p3);
 
-		newVector.y =	this->m[4] * v.x +
-						this->m[5] * v.y +
-						this->m[6] * v.z +
-						this->m[7] * v.w;
+		return Vec4::FromSimd(Simd::Add(Simd::Add(Simd::Add(p0, p1), p2), p3));
+	}
 
-		newVector.z =	this->m[8] * v.x +
-						this->m[9] * v.y +
-						this->m[10] * v.z +
-						this->m[11] * v.w;
+	// Point, w = 1
+	Vec3 operator*(const Vec3 &v)const
+	{
+		Simd::Float4 vec = Simd::Set(v.x, v.y, v.z, 1.0f);
 
-		newVector.w =	this->m[12] * v.x +
-						this->m[13] * v.y +
-						this->m[14] * v.z +
-						this->m[15] * v.w;
+		Simd::Float4 p0 = Simd::Mul(this->Row(0), vec);
+		Simd::Float4 p1 = Simd::Mul(this->Row(1), vec);
+		Simd::Float4 p2 = Simd::Mul(this->Row(2), vec);
+		Simd::Float4 p3 = Simd::Zero();
+		Simd::Transpose(p0, p1, p2, p3);
 
-		return newVector;
+		return Vec3::FromSimd(Simd::Add(Simd::Add(Simd::Add(p0, p1), p2), p3));
 	}
 
-	Vec3 operator*(const Vec3 &v)const
+	// Upper 3x3 transposed times v. For a world direction v this gives the
+	// model space direction with the same furthest point, as dot(M * p, v)
+	// only depends on p through dot(p, transpose(M) * v)
+	Vec3 TransposeRotate(const Vec3 &v)const
+	{
+		return Vec3(this->m[0] * v.x + this->m[4] * v.y + this->m[8] * v.z,
+					this->m[1] * v.x + this->m[5] * v.y + this->m[9] * v.z,
+					this->m[2] * v.x + this->m[6] * v.y + this->m[10] * v.z);
+	}
+
+	// count packed xyz points from in to out as with operator*(Vec3), four at a
+	// time. in and out may be the same array
+	void TransformPoints(const float *in, float *out, const size_t count)const
 	{
-		Vec3 newVector;
+		Simd::Float4 c[12];
+		for (int i = 0; i < 12; i++)
+			c[i] = Simd::Splat(this->m[i]);
 
-		newVector.x =	this->m[0] * v.x +
-						this->m[1] * v.y +
-						this->m[2] * v.z +
-						this->m[3] * 1.0f;
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			Simd::Float4 x, y, z;
+			Simd::LoadPoints(in + i * 3, x, y, z);
 
-		newVector.y =	this->m[4] * v.x +
-						this->m[5] * v.y +
-						this->m[6] * v.z +
-						this->m[7] * 1.0f;
+			Simd::Float4 tx = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[0], x), Simd::Mul(c[1], y)), Simd::Mul(c[2], z)), c[3]);
+			Simd::Float4 ty = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[4], x), Simd::Mul(c[5], y)), Simd::Mul(c[6], z)), c[7]);
+			Simd::Float4 tz = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[8], x), Simd::Mul(c[9], y)), Simd::Mul(c[10], z)), c[11]);
 
-		newVector.z =	this->m[8] * v.x +
-						this->m[9] * v.y +
-						this->m[10] * v.z +
-						this->m[11] * 1.0f;
+			Simd::StorePoints(out + i * 3, tx, ty, tz);
+		}
 
-		return newVector;
+		for (; i < count; i++)
+		{
+			Vec3 v = (*this) * Vec3(in[i * 3], in[i * 3 + 1], in[i * 3 + 2]);
+			out[i * 3 + 0] = v.x;
+			out[i * 3 + 1] = v.y;
+			out[i * 3 + 2] = v.z;
+		}
+	}
+
+	// count points stored one array per axis, transformed to packed xyz in out
+	void TransformPoints(const float *xs, const float *ys, const float *zs, float *out, const size_t count)const
+	{
+		Simd::Float4 c[12];
+		for (int i = 0; i < 12; i++)
+			c[i] = Simd::Splat(this->m[i]);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			Simd::Float4 x = Simd::LoadUnaligned(xs + i);
+			Simd::Float4 y = Simd::LoadUnaligned(ys + i);
+			Simd::Float4 z = Simd::LoadUnaligned(zs + i);
+
+			Simd::Float4 tx = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[0], x), Simd::Mul(c[1], y)), Simd::Mul(c[2], z)), c[3]);
+			Simd::Float4 ty = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[4], x), Simd::Mul(c[5], y)), Simd::Mul(c[6], z)), c[7]);
+			Simd::Float4 tz = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[8], x), Simd::Mul(c[9], y)), Simd::Mul(c[10], z)), c[11]);
+
+			Simd::StorePoints(out + i * 3, tx, ty, tz);
+		}
+
+		for (; i < count; i++)
+		{
+			Vec3 v = (*this) * Vec3(xs[i], ys[i], zs[i]);
+			out[i * 3 + 0] = v.x;
+			out[i * 3 + 1] = v.y;
+			out[i * 3 + 2] = v.z;
+		}
+	}
+
+	// Grow min and max to contain the count points, stored one array per
+	// axis, transformed
+	void TransformAABB(const float *xs, const float *ys, const float *zs, const size_t count, Vec3 &min, Vec3 &max)const
+	{
+		Simd::Float4 c[12];
+		for (int i = 0; i < 12; i++)
+			c[i] = Simd::Splat(this->m[i]);
+
+		Simd::Float4 minX = Simd::Splat(min.x), minY = Simd::Splat(min.y), minZ = Simd::Splat(min.z);
+		Simd::Float4 maxX = Simd::Splat(max.x), maxY = Simd::Splat(max.y), maxZ = Simd::Splat(max.z);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			Simd::Float4 x = Simd::LoadUnaligned(xs + i);
+			Simd::Float4 y = Simd::LoadUnaligned(ys + i);
+			Simd::Float4 z = Simd::LoadUnaligned(zs + i);
+
+			Simd::Float4 tx = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[0], x), Simd::Mul(c[1], y)), Simd::Mul(c[2], z)), c[3]);
+			Simd::Float4 ty = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[4], x), Simd::Mul(c[5], y)), Simd::Mul(c[6], z)), c[7]);
+			Simd::Float4 tz = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(c[8], x), Simd::Mul(c[9], y)), Simd::Mul(c[10], z)), c[11]);
+
+			minX = Simd::Min(tx, minX); maxX = Simd::Max(tx, maxX);
+			minY = Simd::Min(ty, minY); maxY = Simd::Max(ty, maxY);
+			minZ = Simd::Min(tz, minZ); maxZ = Simd::Max(tz, maxZ);
+		}
+
+		min = Vec3(Simd::MinLane(minX), Simd::MinLane(minY), Simd::MinLane(minZ));
+		max = Vec3(Simd::MaxLane(maxX), Simd::MaxLane(maxY), Simd::MaxLane(maxZ));
+
+		for (; i < count; i++)
+		{
+			Vec3 v = (*this) * Vec3(xs[i], ys[i], zs[i]);
+
+			if (v.x < min.x) min.x = v.x;
+			if (v.y < min.y) min.y = v.y;
+			if (v.z < min.z) min.z = v.z;
+
+			if (v.x > max.x) max.x = v.x;
+			if (v.y > max.y) max.y = v.y;
+			if (v.z > max.z) max.z = v.z;
+		}
+	}
+
+
+
+	// Bounds of the box min to max after the transform, from the box alone
+	// (Arvo, Graphics Gems 1990). Exact when the box is only moved, scaled or
+	// turned in quarter turns, otherwise a box containing the turned one
+	void TransformBox(const Vec3 &min, const Vec3 &max, Vec3 &outMin, Vec3 &outMax)const
+	{
+		const float lows[3] = { min.x, min.y, min.z };
+		const float highs[3] = { max.x, max.y, max.z };
+
+		Simd::Float4 low = Simd::Set(this->m[3], this->m[7], this->m[11], 0.0f);
+		Simd::Float4 high = low;
+
+		// Each column scaled by the box's extent along that axis, the smaller
+		// end goes to the min and the larger to the max
+		for (int col = 0; col < 3; col++)
+		{
+			Simd::Float4 column = Simd::Set(this->m[col], this->m[4 + col], this->m[8 + col], 0.0f);
+			Simd::Float4 a = Simd::Mul(column, Simd::Splat(lows[col]));
+			Simd::Float4 b = Simd::Mul(column, Simd::Splat(highs[col]));
+
+			low = Simd::Add(low, Simd::Min(a, b));
+			high = Simd::Add(high, Simd::Max(a, b));
+		}
+
+		outMin = Vec3::FromSimd(low);
+		outMax = Vec3::FromSimd(high);
 	}
 
 
@@ -323,9 +517,9 @@ public:
 	{
 		Matrix newMatrix;
 
-		for (int i = 0; i < 16; i++)
+		for (int row = 0; row < 4; row++)
 		{
-			newMatrix[i] = this->m[i] + m.m[i];
+			newMatrix.SetRow(row, Simd::Add(this->Row(row), m.Row(row)));
 		}
 
 		return newMatrix;
@@ -337,9 +531,9 @@ public:
 	// ------------------------------------------------------------------------
 	void operator=(const Matrix &m)
 	{
-		for (int i = 0; i < 16; i++)
+		for (int row = 0; row < 4; row++)
 		{
-			this->m[i] = m.m[i];
+			this->SetRow(row, m.Row(row));
 		}
 	}
 
@@ -382,13 +576,16 @@ public:
 	{
 		Matrix newMatrix;
 
-		for (int row = 0; row < 4; row++)
-		{
-			for (int col = 0; col < 4; col++)
-			{
-				newMatrix.m[row * 4 + col] = m.m[col * 4 + row];
-			}
-		}
+		Simd::Float4 row0 = m.Row(0);
+		Simd::Float4 row1 = m.Row(1);
+		Simd::Float4 row2 = m.Row(2);
+		Simd::Float4 row3 = m.Row(3);
+		Simd::Transpose(row0, row1, row2, row3);
+
+		newMatrix.SetRow(0, row0);
+		newMatrix.SetRow(1, row1);
+		newMatrix.SetRow(2, row2);
+		newMatrix.SetRow(3, row3);
 
 		return newMatrix;
 	}
@@ -398,8 +595,129 @@ public:
 		m = GetInverse(m);
 	}
 
+	// Inverse of a rotation and translation, the rotation is transposed and
+	// the translation rotated back
+	static Matrix GetRigidInverse(const Matrix &m)
+	{
+		const float *a = m.m;
+
+		// Rows are built in registers, writing single floats and then loading
+		// them as rows would stall on store forwarding
+		Matrix inv;
+		inv.SetRow(0, Simd::Set(a[0], a[4], a[8],  -(a[0] * a[3] + a[4] * a[7] + a[8] * a[11])));
+		inv.SetRow(1, Simd::Set(a[1], a[5], a[9],  -(a[1] * a[3] + a[5] * a[7] + a[9] * a[11])));
+		inv.SetRow(2, Simd::Set(a[2], a[6], a[10], -(a[2] * a[3] + a[6] * a[7] + a[10] * a[11])));
+		return inv;
+	}
+
+	// Inverse of any 3x3 transform and translation, the bottom row has to
+	// be (0, 0, 0, 1)
+	static Matrix GetAffineInverse(const Matrix &m)
+	{
+		const float *a = m.m;
+
+		// Cofactors of the 3x3 part
+		float c00 = a[5] * a[10] - a[6] * a[9];
+		float c01 = a[6] * a[8] - a[4] * a[10];
+		float c02 = a[4] * a[9] - a[5] * a[8];
+
+		// Make sure we can get an inverse
+		float det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+		if (det == 0.0f)
+			return Matrix();
+
+		float r = 1.0f / det;
+		float i00 = c00 * r;
+		float i10 = c01 * r;
+		float i20 = c02 * r;
+		float i01 = (a[2] * a[9] - a[1] * a[10]) * r;
+		float i11 = (a[0] * a[10] - a[2] * a[8]) * r;
+		float i21 = (a[1] * a[8] - a[0] * a[9]) * r;
+		float i02 = (a[1] * a[6] - a[2] * a[5]) * r;
+		float i12 = (a[2] * a[4] - a[0] * a[6]) * r;
+		float i22 = (a[0] * a[5] - a[1] * a[4]) * r;
+
+		Matrix inv;
+		inv.SetRow(0, Simd::Set(i00, i01, i02, -(i00 * a[3] + i01 * a[7] + i02 * a[11])));
+		inv.SetRow(1, Simd::Set(i10, i11, i12, -(i10 * a[3] + i11 * a[7] + i12 * a[11])));
+		inv.SetRow(2, Simd::Set(i20, i21, i22, -(i20 * a[3] + i21 * a[7] + i22 * a[11])));
+		return inv;
+	}
+
+	// Inverse of a projection built by Matrix(FoV, near, far), or any matrix
+	// with only the x and y scale and the lower right 2x2 block set
+	static Matrix GetProjectionInverse(const Matrix &m)
+	{
+		const float *a = m.m;
+		float r = 1.0f / (a[10] * a[15] - a[11] * a[14]);
+
+		Matrix inv;
+		inv.SetRow(0, Simd::Set(1.0f / a[0], 0.0f, 0.0f, 0.0f));
+		inv.SetRow(1, Simd::Set(0.0f, 1.0f / a[5], 0.0f, 0.0f));
+		inv.SetRow(2, Simd::Set(0.0f, 0.0f,  a[15] * r, -a[11] * r));
+		inv.SetRow(3, Simd::Set(0.0f, 0.0f, -a[14] * r,  a[10] * r));
+		return inv;
+	}
+
 	static Matrix GetInverse(const Matrix &m)
 	{
+#if MATH_SSE
+		// Blockwise inversion of the four 2x2 sub-matrices
+		// |A B|
+		// |C D|
+		__m128 row0 = m.Row(0);
+		__m128 row1 = m.Row(1);
+		__m128 row2 = m.Row(2);
+		__m128 row3 = m.Row(3);
+
+		__m128 A = _mm_movelh_ps(row0, row1);
+		__m128 B = _mm_movehl_ps(row1, row0);
+		__m128 C = _mm_movelh_ps(row2, row3);
+		__m128 D = _mm_movehl_ps(row3, row2);
+
+		// Determinants of the blocks, (|A|, |B|, |C|, |D|)
+		__m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(3, 1, 3, 1))),
+			_mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(2, 0, 2, 0))));
+		__m128 detA = MATRIX_SWIZZLE(detSub, 0, 0, 0, 0);
+		__m128 detB = MATRIX_SWIZZLE(detSub, 1, 1, 1, 1);
+		__m128 detC = MATRIX_SWIZZLE(detSub, 2, 2, 2, 2);
+		__m128 detD = MATRIX_SWIZZLE(detSub, 3, 3, 3, 3);
+
+		__m128 D_C = Mat2AdjMul(D, C);
+		__m128 A_B = Mat2AdjMul(A, B);
+
+		// Adjugates of the blocks of the inverse, scaled by |M|
+		__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+		__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+		__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+		__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+
+		// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+		__m128 tr = _mm_mul_ps(A_B, MATRIX_SWIZZLE(D_C, 0, 2, 1, 3));
+		tr = _mm_add_ps(tr, MATRIX_SWIZZLE(tr, 2, 3, 0, 1));
+		tr = _mm_add_ps(tr, MATRIX_SWIZZLE(tr, 1, 0, 3, 2));
+		__m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+		// Make sure we can get an inverse
+		if (_mm_cvtss_f32(detM) == 0.0f)
+			return Matrix();
+
+		__m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+		X = _mm_mul_ps(X, rDetM);
+		Y = _mm_mul_ps(Y, rDetM);
+		Z = _mm_mul_ps(Z, rDetM);
+		W = _mm_mul_ps(W, rDetM);
+
+		// Adjugate the blocks back while storing the rows
+		Matrix result;
+		result.SetRow(0, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+		result.SetRow(1, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+		result.SetRow(2, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+		result.SetRow(3, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+
+		return result;
+#else
 		double Result[4][4];
 		double tmp[12]; /* temp array for pairs */
 		Matrix src;		/* array of transpose source matrix */
@@ -492,5 +810,10 @@ public:
 		}
 		
 		return floatResult;
+#endif
 	}
-};
\ No newline at end of file
+};
+
+#if MATH_SSE
+#undef MATRIX_SWIZZLE
+#endif
\ No newline at end of file
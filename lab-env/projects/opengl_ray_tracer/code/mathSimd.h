@@ -0,0 +1,245 @@
+#pragma once
+
+// Four float vector used by Vec3, Vec4 and Matrix. SSE on x86, NEON on ARM and
+// plain floats elsewhere or when MATH_NO_SIMD is defined.
+//
+// Every operation is lane-wise IEEE arithmetic, so Vec3/Vec4/Matrix give the
+// same results on all backends as long as the sums are done in the same order
+
+#if !defined(MATH_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+	#define MATH_SSE 1
+	#include <xmmintrin.h>
+#elif !defined(MATH_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+	#define MATH_NEON 1
+	#include <arm_neon.h>
+#else
+	#define MATH_SCALAR 1
+#endif
+
+
+namespace Simd
+{
+
+#if MATH_SSE
+
+typedef __m128 Float4;
+
+// Load and Store need 16 byte aligned memory
+inline Float4 Load(const float *p)							{ return _mm_load_ps(p); }
+inline void Store(float *p, const Float4 a)					{ _mm_store_ps(p, a); }
+inline Float4 LoadUnaligned(const float *p)				{ return _mm_loadu_ps(p); }
+inline Float4 Set(float x, float y, float z, float w)		{ return _mm_setr_ps(x, y, z, w); }
+inline Float4 Splat(const float f)							{ return _mm_set1_ps(f); }
+inline Float4 Zero()										{ return _mm_setzero_ps(); }
+
+inline Float4 Add(const Float4 a, const Float4 b)			{ return _mm_add_ps(a, b); }
+inline Float4 Sub(const Float4 a, const Float4 b)			{ return _mm_sub_ps(a, b); }
+inline Float4 Mul(const Float4 a, const Float4 b)			{ return _mm_mul_ps(a, b); }
+inline Float4 Div(const Float4 a, const Float4 b)			{ return _mm_div_ps(a, b); }
+inline Float4 Min(const Float4 a, const Float4 b)			{ return _mm_min_ps(a, b); }
+inline Float4 Max(const Float4 a, const Float4 b)			{ return _mm_max_ps(a, b); }
+
+inline float X(const Float4 a)								{ return _mm_cvtss_f32(a); }
+inline float Y(const Float4 a)								{ return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1))); }
+inline float Z(const Float4 a)								{ return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2))); }
+inline float W(const Float4 a)								{ return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+inline void Transpose(Float4 &r0, Float4 &r1, Float4 &r2, Float4 &r3)
+{
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+// (a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x, 0)
+inline Float4 Cross(const Float4 a, const Float4 b)
+{
+	Float4 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+	Float4 aZXY = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+	Float4 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+	Float4 bZXY = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+	return _mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX));
+}
+
+// Four packed xyz points, no alignment needed
+inline void LoadPoints(const float *p, Float4 &x, Float4 &y, Float4 &z)
+{
+	Float4 a = _mm_loadu_ps(p);			// x0 y0 z0 x1
+	Float4 b = _mm_loadu_ps(p + 4);		// y1 z1 x2 y2
+	Float4 c = _mm_loadu_ps(p + 8);		// z2 x3 y3 z3
+
+	Float4 b2c1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+	x = _mm_shuffle_ps(a, b2c1, _MM_SHUFFLE(2, 0, 3, 0));
+
+	Float4 a1b0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+	Float4 b3c2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+	y = _mm_shuffle_ps(a1b0, b3c2, _MM_SHUFFLE(2, 0, 2, 0));
+
+	Float4 a2b1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+	z = _mm_shuffle_ps(a2b1, c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+inline void StorePoints(float *p, const Float4 x, const Float4 y, const Float4 z)
+{
+	Float4 x0y0 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+	Float4 z0x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+	_mm_storeu_ps(p, _mm_shuffle_ps(x0y0, z0x1, _MM_SHUFFLE(2, 0, 2, 0)));
+
+	Float4 y1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+	Float4 x2y2 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+	_mm_storeu_ps(p + 4, _mm_shuffle_ps(y1z1, x2y2, _MM_SHUFFLE(2, 0, 2, 0)));
+
+	Float4 z2x3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+	Float4 y3z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+	_mm_storeu_ps(p + 8, _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+#elif MATH_NEON
+
+typedef float32x4_t Float4;
+
+inline Float4 Load(const float *p)							{ return vld1q_f32(p); }
+inline void Store(float *p, const Float4 a)					{ vst1q_f32(p, a); }
+inline Float4 LoadUnaligned(const float *p)				{ return vld1q_f32(p); }
+inline Float4 Set(float x, float y, float z, float w)		{ const float f[4] = {x, y, z, w}; return vld1q_f32(f); }
+inline Float4 Splat(const float f)							{ return vdupq_n_f32(f); }
+inline Float4 Zero()										{ return vdupq_n_f32(0.0f); }
+
+inline Float4 Add(const Float4 a, const Float4 b)			{ return vaddq_f32(a, b); }
+inline Float4 Sub(const Float4 a, const Float4 b)			{ return vsubq_f32(a, b); }
+inline Float4 Mul(const Float4 a, const Float4 b)			{ return vmulq_f32(a, b); }
+inline Float4 Min(const Float4 a, const Float4 b)			{ return vminq_f32(a, b); }
+inline Float4 Max(const Float4 a, const Float4 b)			{ return vmaxq_f32(a, b); }
+
+inline float X(const Float4 a)								{ return vgetq_lane_f32(a, 0); }
+inline float Y(const Float4 a)								{ return vgetq_lane_f32(a, 1); }
+inline float Z(const Float4 a)								{ return vgetq_lane_f32(a, 2); }
+inline float W(const Float4 a)								{ return vgetq_lane_f32(a, 3); }
+
+// ARMv7 has no vector divide, its reciprocal estimate wouldn't be exact
+inline Float4 Div(const Float4 a, const Float4 b)
+{
+#if defined(__aarch64__)
+	return vdivq_f32(a, b);
+#else
+	return Set(X(a) / X(b), Y(a) / Y(b), Z(a) / Z(b), W(a) / W(b));
+#endif
+}
+
+inline void Transpose(Float4 &r0, Float4 &r1, Float4 &r2, Float4 &r3)
+{
+	float32x4x2_t t01 = vtrnq_f32(r0, r1);
+	float32x4x2_t t23 = vtrnq_f32(r2, r3);
+	r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+inline Float4 Cross(const Float4 a, const Float4 b)
+{
+	Float4 aYZX = Set(Y(a), Z(a), X(a), 0.0f);
+	Float4 aZXY = Set(Z(a), X(a), Y(a), 0.0f);
+	Float4 bYZX = Set(Y(b), Z(b), X(b), 0.0f);
+	Float4 bZXY = Set(Z(b), X(b), Y(b), 0.0f);
+	return vsubq_f32(vmulq_f32(aYZX, bZXY), vmulq_f32(aZXY, bYZX));
+}
+
+inline void LoadPoints(const float *p, Float4 &x, Float4 &y, Float4 &z)
+{
+	float32x4x3_t v = vld3q_f32(p);
+	x = v.val[0];
+	y = v.val[1];
+	z = v.val[2];
+}
+
+inline void StorePoints(float *p, const Float4 x, const Float4 y, const Float4 z)
+{
+	float32x4x3_t v;
+	v.val[0] = x;
+	v.val[1] = y;
+	v.val[2] = z;
+	vst3q_f32(p, v);
+}
+
+#else
+
+struct Float4
+{
+	float v[4];
+};
+
+inline Float4 Load(const float *p)							{ Float4 r = {{p[0], p[1], p[2], p[3]}}; return r; }
+inline void Store(float *p, const Float4 a)					{ p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+inline Float4 LoadUnaligned(const float *p)				{ return Load(p); }
+inline Float4 Set(float x, float y, float z, float w)		{ Float4 r = {{x, y, z, w}}; return r; }
+inline Float4 Splat(const float f)							{ return Set(f, f, f, f); }
+inline Float4 Zero()										{ return Set(0.0f, 0.0f, 0.0f, 0.0f); }
+
+inline Float4 Add(const Float4 a, const Float4 b)			{ return Set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+inline Float4 Sub(const Float4 a, const Float4 b)			{ return Set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]); }
+inline Float4 Mul(const Float4 a, const Float4 b)			{ return Set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+inline Float4 Div(const Float4 a, const Float4 b)			{ return Set(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]); }
+
+inline Float4 Min(const Float4 a, const Float4 b)
+{
+	return Set(a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+			   a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]);
+}
+
+inline Float4 Max(const Float4 a, const Float4 b)
+{
+	return Set(a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1],
+			   a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]);
+}
+
+inline float X(const Float4 a)								{ return a.v[0]; }
+inline float Y(const Float4 a)								{ return a.v[1]; }
+inline float Z(const Float4 a)								{ return a.v[2]; }
+inline float W(const Float4 a)								{ return a.v[3]; }
+
+inline void Transpose(Float4 &r0, Float4 &r1, Float4 &r2, Float4 &r3)
+{
+	Float4 t0 = Set(r0.v[0], r1.v[0], r2.v[0], r3.v[0]);
+	Float4 t1 = Set(r0.v[1], r1.v[1], r2.v[1], r3.v[1]);
+	Float4 t2 = Set(r0.v[2], r1.v[2], r2.v[2], r3.v[2]);
+	Float4 t3 = Set(r0.v[3], r1.v[3], r2.v[3], r3.v[3]);
+	r0 = t0; r1 = t1; r2 = t2; r3 = t3;
+}
+
+inline Float4 Cross(const Float4 a, const Float4 b)
+{
+	return Set(
+		a.v[1] * b.v[2] - a.v[2] * b.v[1],
+		a.v[2] * b.v[0] - a.v[0] * b.v[2],
+		a.v[0] * b.v[1] - a.v[1] * b.v[0],
+		0.0f);
+}
+
+inline void LoadPoints(const float *p, Float4 &x, Float4 &y, Float4 &z)
+{
+	x = Set(p[0], p[3], p[6], p[9]);
+	y = Set(p[1], p[4], p[7], p[10]);
+	z = Set(p[2], p[5], p[8], p[11]);
+}
+
+inline void StorePoints(float *p, const Float4 x, const Float4 y, const Float4 z)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		p[i * 3 + 0] = x.v[i];
+		p[i * 3 + 1] = y.v[i];
+		p[i * 3 + 2] = z.v[i];
+	}
+}
+
+#endif
+
+
+// Sums in the order x, y, z (, w) like the scalar code did
+inline float Sum3(const Float4 a)		{ return X(a) + Y(a) + Z(a); }
+inline float Sum4(const Float4 a)		{ return X(a) + Y(a) + Z(a) + W(a); }
+
+// Smallest and largest lane
+inline float MinLane(const Float4 a)	{ Float4 m = Min(a, Set(Z(a), W(a), X(a), Y(a))); return X(m) < Y(m) ? X(m) : Y(m); }
+inline float MaxLane(const Float4 a)	{ Float4 m = Max(a, Set(Z(a), W(a), X(a), Y(a))); return X(m) > Y(m) ? X(m) : Y(m); }
+
+} // namespace Simd
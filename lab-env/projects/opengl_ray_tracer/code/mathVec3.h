@@ -2,85 +2,225 @@
 
 #include <cmath>
 
+#include "mathSimd.h"
+
 class Vec4;
 
 
-class Vec3
+// 16 byte aligned so it loads as one SIMD register, the fourth float is
+// padding and kept at 0
+class alignas(16) Vec3
 {
+private:
+
+	Simd::Float4 Load()const
+	{
+		return Simd::Load(&this->x);
+	}
+
+	void Store(const Simd::Float4 v)
+	{
+		Simd::Store(&this->x, v);
+	}
+
+	static Vec3 FromSimd(const Simd::Float4 v)
+	{
+		Vec3 newVector;
+		newVector.Store(v);
+		return newVector;
+	}
+
+	friend class Matrix;
+
+
 public:
 
 	float x;
 	float y;
 	float z;
+	float pad;		// Fills the SIMD register, always 0
 
 
 	// Construction
 	// ------------------------------------------------------------------------
-	Vec3();
-	Vec3(const float x, const float y, const float z);
-	Vec3(const Vec4 &v);
+	constexpr Vec3() : x(0), y(0), z(0), pad(0)
+	{
+
+	}
+
+	constexpr Vec3(const float x, const float y, const float z) : x(x), y(y), z(z), pad(0)
+	{
+
+	}
+
+	constexpr Vec3(const Vec4 &v);
 
 
 	// Addition
 	// ------------------------------------------------------------------------
-	Vec3 operator+(const Vec3 &v)const;
-	void operator+=(const Vec3 &v);
-	Vec3 operator+(const float f)const;
-	void operator+=(const float f);
+	Vec3 operator+(const Vec3 &v)const
+	{
+		return FromSimd(Simd::Add(this->Load(), v.Load()));
+	}
+
+	void operator+=(const Vec3 &v)
+	{
+		this->Store(Simd::Add(this->Load(), v.Load()));
+	}
+
+	Vec3 operator+(const float f)const
+	{
+		return FromSimd(Simd::Add(this->Load(), Simd::Set(f, f, f, 0.0f)));
+	}
+
+	void operator+=(const float f)
+	{
+		this->Store(Simd::Add(this->Load(), Simd::Set(f, f, f, 0.0f)));
+	}
 
 
 	// Subtraction
 	// ------------------------------------------------------------------------
-	Vec3 operator-(const Vec3 &v)const;
-	void operator-=(const Vec3 &v);
-	Vec3 operator-(const float)const;
-	void operator-=(const float);
-	Vec3 operator-()const;
+	Vec3 operator-(const Vec3 &v)const
+	{
+		return FromSimd(Simd::Sub(this->Load(), v.Load()));
+	}
+
+	void operator-=(const Vec3 &v)
+	{
+		this->Store(Simd::Sub(this->Load(), v.Load()));
+	}
+
+	Vec3 operator-(const float f)const
+	{
+		return FromSimd(Simd::Sub(this->Load(), Simd::Set(f, f, f, 0.0f)));
+	}
+
+	void operator-=(const float f)
+	{
+		this->Store(Simd::Sub(this->Load(), Simd::Set(f, f, f, 0.0f)));
+	}
+
+	// Invert
+	Vec3 operator-()const
+	{
+		// Multiply rather than subtract from 0 so that -0 stays -0
+		return FromSimd(Simd::Mul(this->Load(), Simd::Splat(-1.0f)));
+	}
 
 
 	// Multiplication
 	// ------------------------------------------------------------------------
-	Vec3 operator*(const float f)const;
-	void operator*=(const float f);
+	Vec3 operator*(const float f)const
+	{
+		return FromSimd(Simd::Mul(this->Load(), Simd::Splat(f)));
+	}
+
+	void operator*=(const float f)
+	{
+		this->Store(Simd::Mul(this->Load(), Simd::Splat(f)));
+	}
+
 	Vec4 QuaternionMult(const Vec4 &q)const;
 
 
 	// Division
 	// ------------------------------------------------------------------------
-	Vec3 operator/(const float f)const;
-	void operator/=(const float f);
-	
+	Vec3 operator/(const float f)const
+	{
+		return FromSimd(Simd::Div(this->Load(), Simd::Splat(f)));
+	}
+
+	void operator/=(const float f)
+	{
+		this->Store(Simd::Div(this->Load(), Simd::Splat(f)));
+	}
+
 
 	// Equality
 	// ------------------------------------------------------------------------
-	void operator=(const Vec3 &v);
-	bool operator==(const Vec3 &v)const;
-	bool operator!=(const Vec3 &v)const;
+	// Set equal
+	void operator=(const Vec3 &v)
+	{
+		this->Store(v.Load());
+	}
+
+	// Check equality
+	bool operator==(const Vec3 &v)const
+	{
+		return this->x == v.x && this->y == v.y && this->z == v.z;
+	}
+
+	bool operator!=(const Vec3 &v)const
+	{
+		return this->x != v.x || this->y != v.y || this->z != v.z;
+	}
 
 
 	// Vector Length
 	// ------------------------------------------------------------------------
-	float Length()const;
-	float SquareLength()const;
+	float Length()const
+	{
+		return std::sqrt(this->SquareLength());
+	}
+
+	float SquareLength()const
+	{
+		Simd::Float4 v = this->Load();
+		return Simd::Sum3(Simd::Mul(v, v));
+	}
 
 
 	// Vector Normal
 	// ------------------------------------------------------------------------
-	Vec3 Normal()const;
-	void Normalize();
+	// Get vector normal
+	Vec3 Normal()const
+	{
+		return FromSimd(Simd::Div(this->Load(), Simd::Splat(this->Length())));
+	}
+
+	// Normalize vector
+	void Normalize()
+	{
+		this->Store(Simd::Div(this->Load(), Simd::Splat(this->Length())));
+	}
 
 
 	// Static Function
 	// ------------------------------------------------------------------------
-	static float Dot(const Vec3 &v, const Vec3 &u);
-	static Vec3 Cross(const Vec3 &v, const Vec3 &u);
-	static void GetArray(const Vec3 &v, float *array);
+	// Dot product
+	static float Dot(const Vec3 &v, const Vec3 &u)
+	{
+		return Simd::Sum3(Simd::Mul(v.Load(), u.Load()));
+	}
+
+	// Cross product
+	static Vec3 Cross(const Vec3 &v, const Vec3 &u)
+	{
+		return FromSimd(Simd::Cross(v.Load(), u.Load()));
+	}
+
+	static void GetArray(const Vec3 &v, float *array)
+	{
+		array[0] = v.x;
+		array[1] = v.y;
+		array[2] = v.z;
+	}
 
 
 	// Component-wise Operations
 	// ------------------------------------------------------------------------
-	static Vec3 ComponentMultiplication(const Vec3 &v, const Vec3 &u);
-	static Vec3 ComponentDivision(const Vec3 &v, const Vec3 &u);
+	// Multiplication
+	static Vec3 ComponentMultiplication(const Vec3 &v, const Vec3 &u)
+	{
+		return FromSimd(Simd::Mul(v.Load(), u.Load()));
+	}
+
+	// Division, the padding would be 0/0
+	static Vec3 ComponentDivision(const Vec3 &v, const Vec3 &u)
+	{
+		return FromSimd(Simd::Div(v.Load(), Simd::Set(u.x, u.y, u.z, 1.0f)));
+	}
 
 
 
@@ -88,17 +228,18 @@ public:
 	// ------------------------------------------------------------------------
 	friend Vec3 operator+(const float f, const Vec3 &v)
 	{
-		Vec3 newVector(v.x + f, v.y + f, v.z + f);
-		return newVector;
+		return v + f;
 	}
 	friend Vec3 operator-(const float f, const Vec3 &v)
 	{
-		Vec3 newVector(v.x - f, v.y - f, v.z - f);
-		return newVector;
+		return v - f;
 	}
 	friend Vec3 operator*(const float f, const Vec3 &v)
 	{
-		Vec3 newVector(v.x * f, v.y * f, v.z * f);
-		return newVector;
+		return v * f;
 	}
-};
\ No newline at end of file
+};
+
+
+// Vec3 and Vec4 convert between each other
+#include "mathVec4.h"
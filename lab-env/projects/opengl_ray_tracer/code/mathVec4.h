@@ -2,11 +2,35 @@
 
 #include <cmath>
 
-class Vec3;
+#include "mathSimd.h"
+#include "mathVec3.h"
 
 
-class Vec4
+// 16 byte aligned so it loads as one SIMD register
+class alignas(16) Vec4
 {
+private:
+
+	Simd::Float4 Load()const
+	{
+		return Simd::Load(&this->x);
+	}
+
+	void Store(const Simd::Float4 v)
+	{
+		Simd::Store(&this->x, v);
+	}
+
+	static Vec4 FromSimd(const Simd::Float4 v)
+	{
+		Vec4 newVector;
+		newVector.Store(v);
+		return newVector;
+	}
+
+	friend class Matrix;
+
+
 public:
 
 	float x;
@@ -17,66 +41,176 @@ public:
 
 	// Construction
 	// ------------------------------------------------------------------------
-	Vec4();
-	Vec4(float x, float y, float z, float w);
-	Vec4(const Vec3 &v, float w);
+	constexpr Vec4() : x(0), y(0), z(0), w(1)
+	{
+
+	}
+
+	constexpr Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w)
+	{
+
+	}
+
+	constexpr Vec4(const Vec3 &v, float w) : x(v.x), y(v.y), z(v.z), w(w)
+	{
+
+	}
 
 
 	// Addition
 	// ------------------------------------------------------------------------
-	Vec4 operator+(const Vec4 &v)const;
-	void operator+=(const Vec4 &v);
+	Vec4 operator+(const Vec4 &v)const
+	{
+		return FromSimd(Simd::Add(this->Load(), v.Load()));
+	}
+
+	void operator+=(const Vec4 &v)
+	{
+		this->Store(Simd::Add(this->Load(), v.Load()));
+	}
 
 
 	// Subtraction
 	// ------------------------------------------------------------------------
-	Vec4 operator-(const Vec4 &v)const;
-	void operator-=(const Vec4 &v);
-	Vec4 operator-()const;
+	Vec4 operator-(const Vec4 &v)const
+	{
+		return FromSimd(Simd::Sub(this->Load(), v.Load()));
+	}
+
+	void operator-=(const Vec4 &v)
+	{
+		this->Store(Simd::Sub(this->Load(), v.Load()));
+	}
+
+	// Invert
+	Vec4 operator-()const
+	{
+		return FromSimd(Simd::Mul(this->Load(), Simd::Splat(-1.0f)));
+	}
 
 
 	// Multiplication
 	// ------------------------------------------------------------------------
-	Vec4 operator*(const float f)const;
-	void operator*=(const float f);
-	Vec4 QuaternionMult(const Vec4 &q)const;
+	Vec4 operator*(const float f)const
+	{
+		return FromSimd(Simd::Mul(this->Load(), Simd::Splat(f)));
+	}
+
+	void operator*=(const float f)
+	{
+		this->Store(Simd::Mul(this->Load(), Simd::Splat(f)));
+	}
+
+	Vec4 QuaternionMult(const Vec4 &q)const
+	{
+		Vec4 quat;
+		quat.x =  this->x * q.w + this->y * q.z - this->z * q.y + this->w * q.x;
+		quat.y = -this->x * q.z + this->y * q.w + this->z * q.x + this->w * q.y;
+		quat.z =  this->x * q.y - this->y * q.x + this->z * q.w + this->w * q.z;
+		quat.w = -this->x * q.x - this->y * q.y - this->z * q.z + this->w * q.w;
+
+		return quat;
+	}
 
 
 	// Division
 	// ------------------------------------------------------------------------
-	Vec4 operator/(const float f)const;
-	void operator/=(const float f);
-	
+	Vec4 operator/(const float f)const
+	{
+		return FromSimd(Simd::Div(this->Load(), Simd::Splat(f)));
+	}
+
+	void operator/=(const float f)
+	{
+		this->Store(Simd::Div(this->Load(), Simd::Splat(f)));
+	}
+
 
 	// Equality
 	// ------------------------------------------------------------------------
-	void operator=(const Vec4 &v);
-	bool operator==(const Vec4 &v)const;
-	bool operator!=(const Vec4 &v)const;
+	// Set equal
+	void operator=(const Vec4 &v)
+	{
+		this->Store(v.Load());
+	}
+
+	// Check equality
+	bool operator==(const Vec4 &v)const
+	{
+		return this->x == v.x &&
+			   this->y == v.y &&
+			   this->z == v.z &&
+			   this->w == v.w;
+	}
+
+	bool operator!=(const Vec4 &v)const
+	{
+		return this->x != v.x ||
+			   this->y != v.y ||
+			   this->z != v.z ||
+			   this->w != v.w;
+	}
 
 
 	// Vector Length
 	// ------------------------------------------------------------------------
-	float Length()const;
-	float SquareLength()const;
+	float Length()const
+	{
+		return std::sqrt(this->SquareLength());
+	}
+
+	float SquareLength()const
+	{
+		Simd::Float4 v = this->Load();
+		return Simd::Sum4(Simd::Mul(v, v));
+	}
 
 
 	// Vector Normal
 	// ------------------------------------------------------------------------
-	Vec4 Normal()const;
-	void Normalize();
+	// Get vector normal
+	Vec4 Normal()const
+	{
+		return FromSimd(Simd::Div(this->Load(), Simd::Splat(this->Length())));
+	}
+
+	// Normalize vector
+	void Normalize()
+	{
+		this->Store(Simd::Div(this->Load(), Simd::Splat(this->Length())));
+	}
 
 
 	// Static Function
 	// ------------------------------------------------------------------------
-	static float Dot(const Vec4 &v, const Vec4 &u);
-	static void GetArray(const Vec4 &v, float *array);
+	// Dot product
+	static float Dot(const Vec4 &v, const Vec4 &u)
+	{
+		return Simd::Sum4(Simd::Mul(v.Load(), u.Load()));
+	}
+
+	static void GetArray(const Vec4 &v, float *array)
+	{
+		array[0] = v.x;
+		array[1] = v.y;
+		array[2] = v.z;
+		array[3] = v.w;
+	}
 
 
 	// Component-wise Operations
 	// ------------------------------------------------------------------------
-	static Vec4 ComponentMultiplication(const Vec4 &v, const Vec4 &u);
-	static Vec4 ComponentDivision(const Vec4 &v, const Vec4 &u);
+	// Multiplication
+	static Vec4 ComponentMultiplication(const Vec4 &v, const Vec4 &u)
+	{
+		return FromSimd(Simd::Mul(v.Load(), u.Load()));
+	}
+
+	// Division
+	static Vec4 ComponentDivision(const Vec4 &v, const Vec4 &u)
+	{
+		return FromSimd(Simd::Div(v.Load(), u.Load()));
+	}
 
 
 
@@ -84,17 +218,33 @@ public:
 	// ------------------------------------------------------------------------
 	friend Vec4 operator+(const float f, const Vec4 &v)
 	{
-		Vec4 newVector(v.x + f, v.y + f, v.z + f, v.w + f);
-		return newVector;
+		return FromSimd(Simd::Add(v.Load(), Simd::Splat(f)));
 	}
 	friend Vec4 operator-(const float f, const Vec4 &v)
 	{
-		Vec4 newVector(v.x - f, v.y - f, v.z - f, v.w - f);
-		return newVector;
+		return FromSimd(Simd::Sub(v.Load(), Simd::Splat(f)));
 	}
 	friend Vec4 operator*(const float f, const Vec4 &v)
 	{
-		Vec4 newVector(v.x * f, v.y * f, v.z * f, v.w * f);
-		return newVector;
+		return v * f;
 	}
-};
\ No newline at end of file
+};
+
+
+// Vec3 functions that need the full Vec4
+// ------------------------------------------------------------------------
+constexpr Vec3::Vec3(const Vec4 &v) : x(v.x), y(v.y), z(v.z), pad(0)
+{
+
+}
+
+inline Vec4 Vec3::QuaternionMult(const Vec4 &q)const
+{
+	Vec4 quat;
+	quat.x =  this->x * q.w + this->y * q.z - this->z * q.y + 1.0f * q.x;
+	quat.y = -this->x * q.z + this->y * q.w + this->z * q.x + 1.0f * q.y;
+	quat.z =  this->x * q.y - this->y * q.x + this->z * q.w + 1.0f * q.z;
+	quat.w = -this->x * q.x - this->y * q.y - this->z * q.z + 1.0f * q.w;
+
+	return quat;
+}
@@ -1,4 +1,12 @@
 #include "objParser.h"
+#include "mappedFile.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 ObjParser::ObjParser()
 {}
@@ -6,380 +14,622 @@ ObjParser::ObjParser()
 ObjParser::~ObjParser()
 {}
 
-GameObject* ObjParser::LoadMesh(const char *filename)
+
+// Scanning
+// ------------------------------------------------------------------------
+// All functions work on [p, end) and never read past end, the mapped file is
+// not null terminated. None of them move past a newline except LineEnd
+
+static bool IsSpace(const char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* SkipSpaces(const char *p, const char *end)
+{
+	while (p < end && IsSpace(*p))
+		p++;
+	return p;
+}
+
+static const char* SkipToken(const char *p, const char *end)
+{
+	while (p < end && !IsSpace(*p) && *p != '\n')
+		p++;
+	return p;
+}
+
+static const char* LineEnd(const char *p, const char *end)
+{
+	const char *n = (const char*)memchr(p, '\n', end - p);
+	return n != nullptr ? n : end;
+}
+
+// Returns where the number ended, nullptr if there was no number
+static const char* ParseInt(const char *p, const char *end, int &value)
 {
-	// Open file
-	std::ifstream file(filename, std::ios::in);
-	if (!file.is_open())
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
 	{
-		fprintf(stderr, "Could not read file\n");
-		return nullptr;
+		negative = (*p == '-');
+		p++;
 	}
 
+	const char *start = p;
+	int v = 0;
+	while (p < end && *p >= '0' && *p <= '9')
+	{
+		v = v * 10 + (*p - '0');
+		p++;
+	}
 
-	Vec3 min;
-	Vec3 max;
-	float x,y,z;
-	int a,b,c,d,tmp;
-	std::vector<float> tmpValues;
-	GameObject *go = new GameObject();
+	if (p == start)
+		return nullptr;
 
-	// Loop over file
-	while (!file.eof())
-	{
-		std::string line = "";
-		std::getline(file, line);
+	value = negative ? -v : v;
+	return p;
+}
 
+// Any number strtof accepts
+static const char* ParseFloatSlow(const char *p, const char *end, float &value)
+{
+	char buffer[64];
+	size_t length = SkipToken(p, end) - p;
+	if (length >= sizeof(buffer))
+		return nullptr;
 
-		if (line[0] == 'v' && line[1] == ' ')
-		{
-			sscanf(line.c_str(), "v %f %f %f", &x, &y, &z);
-
-			tmpValues.push_back(x);
-			tmpValues.push_back(y);
-			tmpValues.push_back(z);
-
-			// Bounding box
-			if (x < min.x)
-				min.x = x;
-			if (y < min.y)
-				min.y = y;
-			if (z < min.z)
-				min.z = z;
-
-			if (x > max.x)
-				max.x = x;
-			if (y > max.y)
-				max.y = y;
-			if (z > max.z)
-				max.z = z;
-		}
-		// else if (line[0] == 'v' && line[1] == 'n' && line[2] == ' ')
-		// {}
-		// else if (line[0] == 'v' && line[1] == 't' && line[2] == ' ')
-		// {}
-		else if (line[0] == 'f' && line[1] == ' ')
-		{	
-			int success;
-			bool done = false;
-
-			// Quads
-			{
-				if (!done)
-				{
-					// Position only
-					success = sscanf(line.c_str(), "f %i %i %i %i", &a, &b, &c, &d);
-					done = (success == 4);
-					go->nrVerts = 4;
-				}
-				if (!done)
-				{
-					// Position/uv
-					success = sscanf(line.c_str(), "f %i/%i %i/%i %i/%i %i/%i",
-						&a, &tmp,		&b, &tmp,		&c, &tmp,		&d, &tmp);
-					done = (success == 8);
-					go->nrVerts = 4;
-				}
-				if (!done)
-				{
-					// Position/uv/normal
-					success = sscanf(line.c_str(), "f %i/%i/%i %i/%i/%i %i/%i/%i %i/%i/%i",
-						&a, &tmp, &tmp,		&b, &tmp, &tmp,		&c, &tmp, &tmp, 	&d, &tmp, &tmp);
-					done = (success == 12);
-					go->nrVerts = 4;
-				}
-				if (!done)
-				{
-					// Position//normal
-					success = sscanf(line.c_str(), "f %i//%i %i//%i %i//%i %i//%i",
-						&a, &tmp,		&b, &tmp, 		&c, &tmp, 		&d, &tmp);
-					done = (success == 8);
-					go->nrVerts = 4;
-				}
-			}
+	memcpy(buffer, p, length);
+	buffer[length] = '\0';
 
-			// Tris
-			{
-				if (!done)
-				{
-					// Position only
-					success = sscanf(line.c_str(), "f %i %i %i", &a, &b, &c);
-					done = (success == 3);
-					go->nrVerts = 3;
-				}
-				if (!done)
-				{
-					// Position/uv
-					success = sscanf(line.c_str(), "f %i/%i %i/%i %i/%i",
-						&a, &tmp,		&b, &tmp,		&c, &tmp);
-					done = (success == 6);
-					go->nrVerts = 3;
-				}
-				if (!done)
-				{
-					// Position/uv/normal
-					success = sscanf(line.c_str(), "f %i/%i/%i %i/%i/%i %i/%i/%i",
-						&a, &tmp, &tmp,		&b, &tmp, &tmp,		&c, &tmp, &tmp);
-					done = (success == 9);
-					go->nrVerts = 3;
-				}
-				if (!done)
-				{
-					// Position//normal
-					success = sscanf(line.c_str(), "f %i//%i %i//%i %i//%i",
-						&a, &tmp,		&b, &tmp, 		&c, &tmp);
-					done = (success == 6);
-					go->nrVerts = 3;
-				}
-			}
+	char *numberEnd;
+	value = strtof(buffer, &numberEnd);
+	if (numberEnd == buffer)
+		return nullptr;
+	return p + (numberEnd - buffer);
+}
 
+// Rounded like strtof. Decimals with up to 15 digits and a small exponent
+// are exact in double, so one multiply or divide rounds them correctly and
+// the only thing that can go wrong is rounding that double to float again.
+// Everything else goes through strtof
+static const char* ParseFloat(const char *p, const char *end, float &value)
+{
+	static const double powers[] =
+	{
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
 
-			if (!done)
-			{
-				fprintf(stderr, "Invalid .obj file!\n");
-				file.close();
-				return nullptr;
-			}
-			
+	const char *start = p;
 
-			int index = a - 1;
-			go->values.push_back(tmpValues[index*3 + 0]);
-			go->values.push_back(tmpValues[index*3 + 1]);
-			go->values.push_back(tmpValues[index*3 + 2]);
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		p++;
+	}
 
-			index = b - 1;
-			go->values.push_back(tmpValues[index*3 + 0]);
-			go->values.push_back(tmpValues[index*3 + 1]);
-			go->values.push_back(tmpValues[index*3 + 2]);
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
 
-			index = c - 1;
-			go->values.push_back(tmpValues[index*3 + 0]);
-			go->values.push_back(tmpValues[index*3 + 1]);
-			go->values.push_back(tmpValues[index*3 + 2]);
+	while (p < end && *p >= '0' && *p <= '9')
+	{
+		if (mantissa != 0 || *p != '0')
+			digits++;
+		mantissa = mantissa * 10 + (*p - '0');
+		anyDigits = true;
+		p++;
+	}
 
-			if (go->nrVerts == 4)
-			{
-				index = d - 1;
-				go->values.push_back(tmpValues[index*3 + 0]);
-				go->values.push_back(tmpValues[index*3 + 1]);
-				go->values.push_back(tmpValues[index*3 + 2]);
-			}
+	if (p < end && *p == '.')
+	{
+		p++;
+		while (p < end && *p >= '0' && *p <= '9')
+		{
+			if (mantissa != 0 || *p != '0')
+				digits++;
+			mantissa = mantissa * 10 + (*p - '0');
+			exponent--;
+			anyDigits = true;
+			p++;
 		}
 	}
 
+	// Could still be inf or nan
+	if (!anyDigits)
+		return ParseFloatSlow(start, end, value);
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		int e;
+		const char *q = ParseInt(p + 1, end, e);
+		if (q == nullptr || e > 1000 || e < -1000)
+			return ParseFloatSlow(start, end, value);
+		exponent += e;
+		p = q;
+	}
 
-	// Set the AABB for the loaded mesh
-	go->SetAABB(min, max);
+	if (digits > 15 || exponent > 22 || exponent < -22)
+		return ParseFloatSlow(start, end, value);
 
+	double d = (double)mantissa;
+	d = exponent < 0 ? d / powers[-exponent] : d * powers[exponent];
 
-	// fprintf(stderr, "Done parsing file\n");
+	if (d == 0.0)
+	{
+		value = negative ? -0.0f : 0.0f;
+		return p;
+	}
 
-	// Close file
-	file.close();
+	// Below the normal floats the rounding point moves, and exactly between
+	// two floats rounding twice can differ from rounding once
+	uint64_t bits;
+	memcpy(&bits, &d, sizeof(bits));
+	if (d < FLT_MIN || d > FLT_MAX || (bits & 0x1FFFFFFF) == 0x10000000)
+		return ParseFloatSlow(start, end, value);
 
-	return go;
+	value = negative ? -(float)d : (float)d;
+	return p;
 }
 
-void ObjParser::LoadScene(const char *filename, std::vector<GameObject *> &objectsInScene)
+
+// Parsing
+// ------------------------------------------------------------------------
+// Files are parsed in line-aligned chunks, in parallel when there is a thread
+// pool. Counting the lines of every chunk first gives each chunk its first
+// vertex, so faces are resolved to position indices while parsing. Once the
+// chunks are stitched together every object's size is known, and the faces
+// are copied into the objects' indices, again one chunk per task. Last every
+// object takes the positions its faces use and renumbers the faces to them
+
+static Vec3 MaterialColor(const char *name, const size_t length)
 {
-	fprintf(stderr, "Reading file %s\n", filename);
+	if (length == 3 && memcmp(name, "Red", 3) == 0)
+		return Vec3(0.8f, 0.0f, 0.0f);
+	if (length == 5 && memcmp(name, "Green", 5) == 0)
+		return Vec3(0.0f, 0.8f, 0.0f);
+	if (length == 4 && memcmp(name, "Blue", 4) == 0)
+		return Vec3(0.0f, 0.0f, 0.8f);
+	if (length == 5 && memcmp(name, "Black", 5) == 0)
+		return Vec3(0.0f, 0.0f, 0.0f);
+
+	return Vec3(1.0f, 1.0f, 1.0f);
+}
 
+// Chunks smaller than this are not worth a task of their own
+static const size_t MinChunkSize = 1 << 20;
 
-	// Open file
-	std::ifstream file(filename, std::ios::in);
-	if (!file.is_open())
+// Faces of one object within one chunk. The first segment of a chunk
+// continues the object of the chunk before, every o line starts another
+struct Segment
+{
+	Vec3 color;
+	bool hasColor = false;
+
+	// Into the chunk's indices
+	size_t firstIndex = 0;
+	size_t nrFaces = 0;
+	size_t nrCorners = 0;
+	int nrVerts = 0;
+
+	// Where the indices are copied to, set when stitching
+	GameObject *object = nullptr;
+	size_t offset = 0;
+};
+
+struct Chunk
+{
+	const char *begin;
+	const char *end;
+
+	size_t nrLines = 0;
+	size_t nrVertices = 0;
+	size_t nrFaces = 0;
+
+	// Sums of the counts of all chunks before
+	size_t firstLine = 0;
+	size_t firstVertex = 0;
+
+	// Position index of every face corner
+	std::vector<int> indices;
+	std::vector<Segment> segments;
+
+	char error[128];
+};
+
+static void RunTasks(ThreadPool *pool, const int count, const std::function<void(int)> &task)
+{
+	if (pool != nullptr && count > 1)
+		pool->ParallelFor(count, task);
+	else
 	{
-		fprintf(stderr, "Could not read file\n");
-		return;
+		for (int i = 0; i < count; i++)
+			task(i);
 	}
+}
 
+// The first error in file order
+static bool ReportError(const std::vector<Chunk> &chunks)
+{
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		if (chunks[i].error[0] != '\0')
+		{
+			fprintf(stderr, "%s", chunks[i].error);
+			return true;
+		}
+	}
+	return false;
+}
 
-	Vec3 min(10000, 10000, 10000);
-	Vec3 max(-10000, -10000, -10000);
-	float x,y,z;
-	int a,b,c,d,tmp;
-	std::vector<float> tmpValues;
-	GameObject *go = nullptr;
+static void SplitChunks(const char *begin, const char *end, const int nrChunks, std::vector<Chunk> &chunks)
+{
+	size_t size = (end - begin) / nrChunks;
 
-	// Loop over file
-	while (!file.eof())
+	const char *p = begin;
+	while (p < end)
 	{
-		std::string line = "";
-		std::getline(file, line);
+		Chunk chunk;
+		chunk.begin = p;
+		chunk.end = (size_t)(end - p) > size + size / 2 ? LineEnd(p + size, end) : end;
+		if (chunk.end < end)
+			chunk.end++;
+		chunk.error[0] = '\0';
+		chunks.push_back(chunk);
+
+		p = chunk.end;
+	}
+}
 
+static void CountChunk(Chunk &chunk)
+{
+	const char *p = chunk.begin;
+	while (p < chunk.end)
+	{
+		const char *lineEnd = LineEnd(p, chunk.end);
+		chunk.nrLines++;
 
-		if (line[0] == 'v' && line[1] == ' ')
+		if (lineEnd - p >= 2 && IsSpace(p[1]))
 		{
-			sscanf(line.c_str(), "v %f %f %f", &x, &y, &z);
-
-			tmpValues.push_back(x);
-			tmpValues.push_back(y);
-			tmpValues.push_back(z);
-
-			// Bounding box
-			if (x < min.x)
-				min.x = x;
-			if (y < min.y)
-				min.y = y;
-			if (z < min.z)
-				min.z = z;
-
-			if (x > max.x)
-				max.x = x;
-			if (y > max.y)
-				max.y = y;
-			if (z > max.z)
-				max.z = z;
+			if (p[0] == 'v')
+				chunk.nrVertices++;
+			else if (p[0] == 'f')
+				chunk.nrFaces++;
 		}
-		else if (line[0] == 'f' && line[1] == ' ')
-		{	
-			int success;
-			bool done = false;
 
-			// Quads
+		p = lineEnd + 1;
+	}
+}
+
+// Reads the chunk's vertex positions into positions and resolves its faces.
+// Without splitObjects o and usemtl lines are ignored
+static bool ParseChunk(Chunk &chunk, float *positions, const size_t nrPositions, const bool splitObjects)
+{
+	chunk.indices.reserve(chunk.nrFaces * 3);
+	chunk.segments.push_back(Segment());
+
+	Segment *segment = &chunk.segments.back();
+	size_t vertex = chunk.firstVertex;
+	size_t lineNumber = chunk.firstLine;
+
+	const char *p = chunk.begin;
+	const char *end = chunk.end;
+	while (p < end)
+	{
+		lineNumber++;
+
+		// v and f lines are parsed up to their newline, the rest are skipped
+		if (end - p < 2 || !IsSpace(p[1]))
+		{
+			const char *lineEnd = LineEnd(p, end);
+
+			// usemtl is the only keyword longer than a letter that matters
+			if (splitObjects && lineEnd - p > 7 && memcmp(p, "usemtl", 6) == 0 && IsSpace(p[6]))
 			{
-				if (!done)
-				{
-					// Position only
-					success = sscanf(line.c_str(), "f %i %i %i %i", &a, &b, &c, &d);
-					done = (success == 4);
-					go->nrVerts = 4;
-				}
-				if (!done)
-				{
-					// Position/uv
-					success = sscanf(line.c_str(), "f %i/%i %i/%i %i/%i %i/%i",
-						&a, &tmp,		&b, &tmp,		&c, &tmp,		&d, &tmp);
-					done = (success == 8);
-					go->nrVerts = 4;
-				}
-				if (!done)
-				{
-					// Position/uv/normal
-					success = sscanf(line.c_str(), "f %i/%i/%i %i/%i/%i %i/%i/%i %i/%i/%i",
-						&a, &tmp, &tmp,		&b, &tmp, &tmp,		&c, &tmp, &tmp, 	&d, &tmp, &tmp);
-					done = (success == 12);
-					go->nrVerts = 4;
-				}
-				if (!done)
+				const char *name = SkipSpaces(p + 7, lineEnd);
+				segment->color = MaterialColor(name, SkipToken(name, lineEnd) - name);
+				segment->hasColor = true;
+			}
+			p = lineEnd + 1;
+		}
+		else if (p[0] == 'v')
+		{
+			float *v = &positions[vertex * 3];
+			const char *q = p + 2;
+			for (int i = 0; i < 3; i++)
+			{
+				q = SkipSpaces(q, end);
+				q = ParseFloat(q, end, v[i]);
+				if (q == nullptr)
 				{
-					// Position//normal
-					success = sscanf(line.c_str(), "f %i//%i %i//%i %i//%i %i//%i",
-						&a, &tmp,		&b, &tmp, 		&c, &tmp, 		&d, &tmp);
-					done = (success == 8);
-					go->nrVerts = 4;
+					snprintf(chunk.error, sizeof(chunk.error), "Invalid vertex on line %zu\n", lineNumber);
+					return false;
 				}
 			}
+			vertex++;
 
-			// Tris
+			// A w coordinate or vertex color may follow
+			p = LineEnd(q, end) + 1;
+		}
+		else if (p[0] == 'f')
+		{
+			int nrCorners = 0;
+			const char *q = SkipSpaces(p + 2, end);
+			while (q < end && *q != '\n')
 			{
-				if (!done)
-				{
-					// Position only
-					success = sscanf(line.c_str(), "f %i %i %i", &a, &b, &c);
-					done = (success == 3);
-					go->nrVerts = 3;
-				}
-				if (!done)
+				int index;
+				const char *indexEnd = ParseInt(q, end, index);
+				if (indexEnd == nullptr || nrCorners == 4)
 				{
-					// Position/uv
-					success = sscanf(line.c_str(), "f %i/%i %i/%i %i/%i",
-						&a, &tmp,		&b, &tmp,		&c, &tmp);
-					done = (success == 6);
-					go->nrVerts = 3;
+					snprintf(chunk.error, sizeof(chunk.error), "Invalid .obj file! Only triangles and quads are supported, line %zu\n", lineNumber);
+					return false;
 				}
-				if (!done)
-				{
-					// Position/uv/normal
-					success = sscanf(line.c_str(), "f %i/%i/%i %i/%i/%i %i/%i/%i",
-						&a, &tmp, &tmp,		&b, &tmp, &tmp,		&c, &tmp, &tmp);
-					done = (success == 9);
-					go->nrVerts = 3;
-				}
-				if (!done)
+
+				// Negative indices count back from the latest vertex
+				long long resolved = index < 0 ? (long long)vertex + index : (long long)index - 1;
+				if (resolved < 0 || (size_t)resolved >= nrPositions)
 				{
-					// Position//normal
-					success = sscanf(line.c_str(), "f %i//%i %i//%i %i//%i",
-						&a, &tmp,		&b, &tmp, 		&c, &tmp);
-					done = (success == 6);
-					go->nrVerts = 3;
+					snprintf(chunk.error, sizeof(chunk.error), "Invalid .obj file! Face refers to a missing vertex, line %zu\n", lineNumber);
+					return false;
 				}
+				chunk.indices.push_back((int)resolved);
+				nrCorners++;
+
+				// Skip /uv/normal
+				q = SkipSpaces(SkipToken(indexEnd, end), end);
+			}
+
+			if (nrCorners < 3)
+			{
+				snprintf(chunk.error, sizeof(chunk.error), "Invalid .obj file! Only triangles and quads are supported, line %zu\n", lineNumber);
+				return false;
 			}
 
+			segment->nrFaces++;
+			segment->nrCorners += nrCorners;
+			segment->nrVerts = nrCorners;
 
-			if (!done)
+			p = q + 1;
+		}
+		else
+		{
+			if (p[0] == 'o' && splitObjects)
 			{
-				fprintf(stderr, "Invalid .obj file!\n");
-				file.close();
-				return;
+				chunk.segments.push_back(Segment());
+				segment = &chunk.segments.back();
+				segment->firstIndex = chunk.indices.size();
 			}
-			
 
-			int index = a - 1;
-			go->values.push_back(tmpValues[index*3 + 0]);
-			go->values.push_back(tmpValues[index*3 + 1]);
-			go->values.push_back(tmpValues[index*3 + 2]);
+			p = LineEnd(p, end) + 1;
+		}
+	}
+
+	return true;
+}
+
+// Gives every segment its object and place in the object's indices, in file
+// order. Faces before the first o line get an object of their own
+static void StitchSegments(std::vector<Chunk> &chunks, const bool splitObjects, std::vector<GameObject*> &objects)
+{
+	GameObject *go = splitObjects ? nullptr : objects.back();
+	size_t nrCorners = 0;
 
-			index = b - 1;
-			go->values.push_back(tmpValues[index*3 + 0]);
-			go->values.push_back(tmpValues[index*3 + 1]);
-			go->values.push_back(tmpValues[index*3 + 2]);
+	Vec3 color(1.0f, 1.0f, 1.0f);
 
-			index = c - 1;
-			go->values.push_back(tmpValues[index*3 + 0]);
-			go->values.push_back(tmpValues[index*3 + 1]);
-			go->values.push_back(tmpValues[index*3 + 2]);
+	for (size_t c = 0; c < chunks.size(); c++)
+	{
+		for (size_t s = 0; s < chunks[c].segments.size(); s++)
+		{
+			Segment &segment = chunks[c].segments[s];
 
-			if (go->nrVerts == 4)
+			bool newObject = (s > 0) || (go == nullptr && segment.nrFaces > 0);
+			if (newObject)
 			{
-				index = d - 1;
-				go->values.push_back(tmpValues[index*3 + 0]);
-				go->values.push_back(tmpValues[index*3 + 1]);
-				go->values.push_back(tmpValues[index*3 + 2]);
+				if (go != nullptr)
+					go->indices.resize(nrCorners);
+
+				// An o line resets the color, the first object keeps what came before
+				if (s > 0)
+					color = Vec3(1.0f, 1.0f, 1.0f);
+
+				go = new GameObject();
+				go->color = color;
+				objects.push_back(go);
+				nrCorners = 0;
+			}
+
+			if (segment.hasColor)
+			{
+				color = segment.color;
+				if (go != nullptr)
+					go->color = color;
 			}
-		}
 
-		else if (line[0] == 'o' && line[1] == ' ')
-		{
 			if (go != nullptr)
-				go->SetAABB(min, max);
-			
-			
-			// Reset AABB values
-			min = Vec3(10000, 10000, 10000);
-			max = Vec3(-10000, -10000, -10000);
-
-			// Create a new GameObject
-			go = new GameObject();
-			objectsInScene.push_back(go);
-			
-		}
+			{
+				if (segment.nrFaces > 0)
+					go->nrVerts = segment.nrVerts;
 
-		else if (line.substr(0, 6) == "usemtl")
-		{
-			if (line.substr(7) == "Red")
-				go->color = Vec3(0.8f, 0.0f, 0.0f);
-			else if (line.substr(7) == "Green")
-				go->color = Vec3(0.0f, 0.8f, 0.0f);
-			else if (line.substr(7) == "Blue")
-				go->color = Vec3(0.0f, 0.0f, 0.8f);
-			else if (line.substr(7) == "White")
-				go->color = Vec3(1.0f, 1.0f, 1.0f);
-			else if (line.substr(7) == "Black")
-				go->color = Vec3(0.0f, 0.0f, 0.0f);
-			else
-				go->color = Vec3(1.0f, 1.0f, 1.0f);
-			
+				segment.object = go;
+				segment.offset = nrCorners;
+				nrCorners += segment.nrCorners;
+			}
 		}
 	}
 
-	// When reaching the end of the file, set the AABB of the last object as well
-	go->SetAABB(min, max);
+	// When reaching the end of the file, size the last object as well
+	if (go != nullptr)
+		go->indices.resize(nrCorners);
+}
+
+static void CopyChunk(const Chunk &chunk)
+{
+	for (size_t s = 0; s < chunk.segments.size(); s++)
+	{
+		const Segment &segment = chunk.segments[s];
+		if (segment.object == nullptr || segment.nrCorners == 0)
+			continue;
+
+		memcpy(&segment.object->indices[segment.offset], &chunk.indices[segment.firstIndex],
+			   segment.nrCorners * sizeof(int));
+	}
+}
+
+// Keeps the positions the object's faces use, in file order, and renumbers
+// the faces from file positions to the object's own
+static void CompactObject(GameObject *go, const float *positions)
+{
+	if (go->indices.empty())
+		return;
+
+	std::vector<int> &indices = go->indices;
+	int first = *std::min_element(indices.begin(), indices.end());
+	int last = *std::max_element(indices.begin(), indices.end());
+
+	std::vector<int> local(last - first + 1, -1);
+	for (size_t i = 0; i < indices.size(); i++)
+		local[indices[i] - first] = 0;
+
+	int nrUsed = 0;
+	for (size_t i = 0; i < local.size(); i++)
+	{
+		if (local[i] == 0)
+			local[i] = nrUsed++;
+	}
+
+	go->xs.resize(nrUsed);
+	go->ys.resize(nrUsed);
+	go->zs.resize(nrUsed);
+	for (size_t i = 0; i < local.size(); i++)
+	{
+		if (local[i] < 0)
+			continue;
+
+		const float *position = &positions[(first + i) * 3];
+		go->xs[local[i]] = position[0];
+		go->ys[local[i]] = position[1];
+		go->zs[local[i]] = position[2];
+	}
+
+	for (size_t i = 0; i < indices.size(); i++)
+		indices[i] = local[indices[i] - first];
 
+	go->UpdateAABB();
+}
+
+// With splitObjects every o line starts a new object and usemtl sets its
+// color, otherwise everything goes into objects[0]. Faces are triangles or
+// quads, uvs and normals are skipped
+static bool ParseObj(const char *begin, const char *end, const bool splitObjects,
+					 std::vector<GameObject*> &objects, ThreadPool *pool)
+{
+	int nrChunks = 1;
+	if (pool != nullptr)
+		nrChunks = (int)std::max<size_t>(1, std::min<size_t>(pool->NrThreads() * 4, (end - begin) / MinChunkSize));
+
+	std::vector<Chunk> chunks;
+	SplitChunks(begin, end, nrChunks, chunks);
+
+	RunTasks(pool, chunks.size(), [&](int i)
+	{
+		CountChunk(chunks[i]);
+	});
+
+	size_t nrVertices = 0;
+	size_t nrLines = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		chunks[i].firstVertex = nrVertices;
+		chunks[i].firstLine = nrLines;
+		nrVertices += chunks[i].nrVertices;
+		nrLines += chunks[i].nrLines;
+	}
+
+	std::vector<float> positions(nrVertices * 3);
+	RunTasks(pool, chunks.size(), [&](int i)
+	{
+		ParseChunk(chunks[i], positions.data(), nrVertices, splitObjects);
+	});
+	if (ReportError(chunks))
+		return false;
+
+	StitchSegments(chunks, splitObjects, objects);
+
+	RunTasks(pool, chunks.size(), [&](int i)
+	{
+		CopyChunk(chunks[i]);
+	});
 
-	
-	fprintf(stderr, "Done parsing file. Created %li objects\n", objectsInScene.size());
+	RunTasks(pool, objects.size(), [&](int i)
+	{
+		CompactObject(objects[i], positions.data());
+	});
+
+	return true;
+}
+
+
+GameObject* ObjParser::LoadMesh(const char *filename)
+{
+	return Load(filename, nullptr);
+}
+
+GameObject* ObjParser::LoadMesh(const char *filename, ThreadPool &pool)
+{
+	return Load(filename, &pool);
+}
+
+void ObjParser::LoadScene(const char *filename, std::vector<GameObject*> &objectsInScene)
+{
+	Load(filename, objectsInScene, nullptr);
+}
 
-	// Close file
-	file.close();
-}
\ No newline at end of file
+void ObjParser::LoadScene(const char *filename, std::vector<GameObject*> &objectsInScene, ThreadPool &pool)
+{
+	Load(filename, objectsInScene, &pool);
+}
+
+GameObject* ObjParser::Load(const char *filename, ThreadPool *pool)
+{
+	MappedFile file;
+	if (!file.Open(filename))
+	{
+		fprintf(stderr, "Could not read file %s\n", filename);
+		return nullptr;
+	}
+
+	std::vector<GameObject*> objects(1, new GameObject());
+	if (!ParseObj(file.Data(), file.Data() + file.Size(), false, objects, pool))
+	{
+		delete objects[0];
+		return nullptr;
+	}
+
+	return objects[0];
+}
+
+void ObjParser::Load(const char *filename, std::vector<GameObject*> &objectsInScene, ThreadPool *pool)
+{
+	fprintf(stderr, "Reading file %s\n", filename);
+
+	MappedFile file;
+	if (!file.Open(filename))
+	{
+		fprintf(stderr, "Could not read file %s\n", filename);
+		return;
+	}
+
+	std::vector<GameObject*> objects;
+	if (!ParseObj(file.Data(), file.Data() + file.Size(), true, objects, pool))
+	{
+		for (size_t i = 0; i < objects.size(); i++)
+			delete objects[i];
+		return;
+	}
+
+	objectsInScene.insert(objectsInScene.end(), objects.begin(), objects.end());
+
+	fprintf(stderr, "Done parsing file. Created %li objects\n", objects.size());
+}
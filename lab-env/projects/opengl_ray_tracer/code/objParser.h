@@ -7,6 +7,7 @@
 
 #include "mathVec3.h"
 #include "gameObject.h"
+#include "threadPool.h"
 
 class ObjParser
 {
@@ -17,4 +18,13 @@ public:
 	static GameObject* LoadMesh(const char *filename);
 	static void LoadScene(const char *filename, std::vector<GameObject*> &objectsInScene);
 
+	// Large files are split into chunks that are parsed on the pool
+	static GameObject* LoadMesh(const char *filename, ThreadPool &pool);
+	static void LoadScene(const char *filename, std::vector<GameObject*> &objectsInScene, ThreadPool &pool);
+
+private:
+
+	static GameObject* Load(const char *filename, ThreadPool *pool);
+	static void Load(const char *filename, std::vector<GameObject*> &objectsInScene, ThreadPool *pool);
+
 };
\ No newline at end of file
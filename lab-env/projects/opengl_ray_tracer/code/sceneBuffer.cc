@@ -0,0 +1,152 @@
+#include "sceneBuffer.h"
+#include "threadPool.h"
+
+#include <algorithm>
+
+
+SceneBuffer::SceneBuffer()
+{}
+
+SceneBuffer::~SceneBuffer()
+{}
+
+
+// The parts of an object that depend on its transform, from the AABB in the
+// header on. Returns the number of floats written
+static int PackTransformed(GameObject *go, float *arr)
+{
+	int index = 0;
+
+	arr[index++] = go->aabbMin.x;
+	arr[index++] = go->aabbMin.y;
+	arr[index++] = go->aabbMin.z;
+	arr[index++] = go->aabbMax.x;
+	arr[index++] = go->aabbMax.y;
+	arr[index++] = go->aabbMax.z;
+
+	int nrPositions = go->NrPositions();
+	arr[index++] = nrPositions;
+
+	// Insert transformed vertex positions
+	if (nrPositions > 0)
+		go->transform.TransformPoints(go->xs.data(), go->ys.data(), go->zs.data(), &arr[index], nrPositions);
+	index += nrPositions * 3;
+
+	go->moved = false;
+	return index;
+}
+
+
+void SceneBuffer::Pack(const std::vector<GameObject*> &go, std::vector<float> &arr)
+{
+	int nrObjects = go.size();
+	int nrFloats = nrObjects + 1;
+	for (int i = 0; i < nrObjects; i++)
+	{
+		nrFloats += go[i]->NrPositions() * 3 + go[i]->indices.size();
+
+		// 			nrVerts,	isPortal, 	pos,	normal, color,	AABB,	nrPositions
+		nrFloats += 1 + 		1 + 		3 +		3 + 	3 +		6 +		1;
+	}
+
+	arr.resize(nrFloats);
+	int index = 0;
+
+	arr[index++] = nrObjects;
+
+	// First values are nr of floats in each object
+	for (int i = 0; i < nrObjects; i++)
+	{
+		arr[index++] = ObjectHeaderSize + go[i]->NrPositions() * 3 + go[i]->indices.size();
+	}
+
+	// Add all values
+	for (int i = 0; i < nrObjects; i++)
+	{
+		// Quad or tri
+		arr[index++] = go[i]->nrVerts;
+
+		// isPortal
+		arr[index++] = go[i]->isPortal;
+
+		// Portal position
+		arr[index++] = go[i]->portalPosition.x;
+		arr[index++] = go[i]->portalPosition.y;
+		arr[index++] = go[i]->portalPosition.z;
+
+		// Portal normal
+		arr[index++] = go[i]->portalNormal.x;
+		arr[index++] = go[i]->portalNormal.y;
+		arr[index++] = go[i]->portalNormal.z;
+
+		// Color of object
+		arr[index++] = go[i]->color.x;
+		arr[index++] = go[i]->color.y;
+		arr[index++] = go[i]->color.z;
+
+		// AABB, nrPositions and the transformed vertex positions
+		index += PackTransformed(go[i], &arr[index]);
+
+		// Faces
+		const std::vector<int> &indices = go[i]->indices;
+		for (size_t j = 0; j < indices.size(); j++)
+			arr[index++] = indices[j];
+	}
+}
+
+void SceneBuffer::Update(const std::vector<GameObject*> &go, std::vector<float> &arr, size_t &first, size_t &last, ThreadPool *pool)
+{
+	first = arr.size();
+	last = 0;
+
+	// Header floats before the AABB
+	const size_t aabbOffset = 11;
+
+	// Where the moved objects go, found first so they can be packed in any order
+	std::vector<int> moved;
+	std::vector<size_t> offsets;
+
+	size_t start = 1 + go.size();
+	for (size_t i = 0; i < go.size(); i++)
+	{
+		if (go[i]->moved)
+		{
+			// AABB, nrPositions and the positions
+			size_t end = start + aabbOffset + 7 + go[i]->NrPositions() * 3;
+
+			if (start + aabbOffset < first)
+				first = start + aabbOffset;
+			if (end > last)
+				last = end;
+
+			moved.push_back(i);
+			offsets.push_back(start + aabbOffset);
+		}
+
+		start += (size_t)arr[1 + i];
+	}
+
+	if (first >= last)
+	{
+		first = last = 0;
+		return;
+	}
+
+	// A few objects per pool task, most are small
+	const int batchSize = 16;
+	int count = moved.size();
+	if (pool != nullptr && count > batchSize)
+	{
+		pool->ParallelFor((count + batchSize - 1) / batchSize, [&](int batch)
+		{
+			int end = std::min(count, (batch + 1) * batchSize);
+			for (int i = batch * batchSize; i < end; i++)
+				PackTransformed(go[moved[i]], &arr[offsets[i]]);
+		});
+	}
+	else
+	{
+		for (int i = 0; i < count; i++)
+			PackTransformed(go[moved[i]], &arr[offsets[i]]);
+	}
+}
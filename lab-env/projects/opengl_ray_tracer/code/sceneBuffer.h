@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include "gameObject.h"
+
+class ThreadPool;
+
+
+// Packs GameObjects into the float layout read by rayTracer.glsl and CpuTracer
+class SceneBuffer
+{
+public:
+
+	// nrVerts, isPortal, portal position, portal normal, color, AABB, nrPositions
+	static const int ObjectHeaderSize = 18;
+
+
+	SceneBuffer();
+	~SceneBuffer();
+
+	/*
+		1x float nrObjects
+		nrObjects float nrValues (header + position floats + indices)
+
+		nrObjects *
+		{
+			ObjectHeaderSize floats
+			nrPositions * 3 floats world space vertex positions
+			nrVerts floats per face, position numbers
+		}
+
+		The indices are floats like the counts, exact up to 2^24 positions
+		per object
+	*/
+	static void Pack(const std::vector<GameObject*> &go, std::vector<float> &arr);
+
+	// Rewrite the AABB and positions of the objects that moved since arr was
+	// packed from the same objects. [first, last) are the floats written,
+	// empty when nothing moved. The objects are packed on the pool when one
+	// is given
+	static void Update(const std::vector<GameObject*> &go, std::vector<float> &arr, size_t &first, size_t &last,
+					   ThreadPool *pool = nullptr);
+};
@@ -0,0 +1,243 @@
+#include "sceneFile.h"
+#include "sceneBuffer.h"
+
+#include <cstdio>
+#include <cstring>
+
+
+/*
+	File layout, little endian:
+		4x char		"RTSC"
+		1x uint32	version
+		1x uint32	nrObjects
+		1x uint32	nrGpuFloats
+
+		nrGpuFloats float	SceneBuffer::Pack of the objects
+
+		nrObjects *
+		{
+			1x int32	cameraRotation
+			1x uint32	nrPositions
+			1x uint32	nrIndices
+			16x float	transform
+			6x float	model space AABB
+			nrPositions float	x of the model space vertices
+			nrPositions float	y
+			nrPositions float	z
+			nrIndices int32	vertex numbers of the faces
+		}
+
+	Every field is 4 bytes so the floats stay aligned in the mapped file
+*/
+static const char SceneMagic[4] = { 'R', 'T', 'S', 'C' };
+static const uint32_t SceneVersion = 3;
+static const size_t HeaderSize = 16;
+static const size_t RecordHeaderSize = 3 * 4 + 16 * 4 + 6 * 4;
+
+
+static uint32_t ReadUint(const char *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+
+SceneFile::SceneFile()
+{}
+
+SceneFile::~SceneFile()
+{}
+
+
+bool SceneFile::Write(const char *filename, const std::vector<GameObject*> &objects)
+{
+	std::vector<float> packed;
+	SceneBuffer::Pack(objects, packed);
+
+	FILE *file = fopen(filename, "wb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Could not write scene %s\n", filename);
+		return false;
+	}
+
+	uint32_t nrObjects = objects.size();
+	uint32_t nrGpuFloats = packed.size();
+	fwrite(SceneMagic, 1, sizeof(SceneMagic), file);
+	fwrite(&SceneVersion, sizeof(SceneVersion), 1, file);
+	fwrite(&nrObjects, sizeof(nrObjects), 1, file);
+	fwrite(&nrGpuFloats, sizeof(nrGpuFloats), 1, file);
+	fwrite(packed.data(), sizeof(float), packed.size(), file);
+
+	for (uint32_t i = 0; i < nrObjects; i++)
+	{
+		GameObject *go = objects[i];
+		int32_t cameraRotation = go->cameraRotation;
+		uint32_t nrPositions = go->NrPositions();
+		uint32_t nrIndices = go->indices.size();
+
+		float transform[16];
+		for (int j = 0; j < 16; j++)
+			transform[j] = go->transform[j];
+
+		float localAABB[6] =
+		{
+			go->localMin.x, go->localMin.y, go->localMin.z,
+			go->localMax.x, go->localMax.y, go->localMax.z
+		};
+
+		fwrite(&cameraRotation, sizeof(cameraRotation), 1, file);
+		fwrite(&nrPositions, sizeof(nrPositions), 1, file);
+		fwrite(&nrIndices, sizeof(nrIndices), 1, file);
+		fwrite(transform, sizeof(float), 16, file);
+		fwrite(localAABB, sizeof(float), 6, file);
+		fwrite(go->xs.data(), sizeof(float), nrPositions, file);
+		fwrite(go->ys.data(), sizeof(float), nrPositions, file);
+		fwrite(go->zs.data(), sizeof(float), nrPositions, file);
+		fwrite(go->indices.data(), sizeof(int), nrIndices, file);
+	}
+
+	bool ok = !ferror(file);
+	ok = (fclose(file) == 0) && ok;
+	if (!ok)
+	{
+		fprintf(stderr, "Could not write scene %s\n", filename);
+		return false;
+	}
+
+	fprintf(stderr, "Wrote %u objects, %u floats to %s\n", nrObjects, nrGpuFloats, filename);
+	return true;
+}
+
+bool SceneFile::Open(const char *filename)
+{
+	this->Close();
+
+	if (!this->file.Open(filename))
+		return false;
+
+	const char *data = this->file.Data();
+	size_t size = this->file.Size();
+
+	bool valid =
+		size >= HeaderSize &&
+		memcmp(data, SceneMagic, sizeof(SceneMagic)) == 0 &&
+		ReadUint(data + 4) == SceneVersion;
+	if (!valid)
+	{
+		fprintf(stderr, "Invalid or old scene %s\n", filename);
+		this->Close();
+		return false;
+	}
+
+	uint32_t nrObjects = ReadUint(data + 8);
+	uint32_t nrGpuFloats = ReadUint(data + 12);
+
+	// Walk the object records so a truncated file is found here and not
+	// while creating the objects
+	size_t offset = HeaderSize + (size_t)nrGpuFloats * sizeof(float);
+	size_t objectOffset = offset;
+	for (uint32_t i = 0; i < nrObjects && offset <= size; i++)
+	{
+		if (size - offset < RecordHeaderSize)
+		{
+			offset = size + 1;
+			break;
+		}
+		offset += RecordHeaderSize + ((size_t)ReadUint(data + offset + 4) * 3 + ReadUint(data + offset + 8)) * 4;
+	}
+
+	// The packed object sizes have to add up to the GPU data
+	size_t nrPacked = 1 + (size_t)nrObjects;
+	if (offset <= size && nrGpuFloats >= nrPacked)
+	{
+		const float *gpuData = (const float*)(data + HeaderSize);
+		for (uint32_t i = 0; i < nrObjects; i++)
+			nrPacked += (size_t)gpuData[1 + i];
+	}
+
+	if (offset > size || nrPacked != nrGpuFloats)
+	{
+		fprintf(stderr, "Scene %s is truncated\n", filename);
+		this->Close();
+		return false;
+	}
+
+	this->gpuData = (const float*)(data + HeaderSize);
+	this->objectData = data + objectOffset;
+	this->nrObjects = nrObjects;
+	this->nrGpuFloats = nrGpuFloats;
+
+	return true;
+}
+
+void SceneFile::Close()
+{
+	this->file.Close();
+	this->gpuData = nullptr;
+	this->objectData = nullptr;
+	this->nrObjects = 0;
+	this->nrGpuFloats = 0;
+}
+
+
+const float* SceneFile::GpuData()const
+{
+	return this->gpuData;
+}
+
+size_t SceneFile::GpuSize()const
+{
+	return this->nrGpuFloats * sizeof(float);
+}
+
+
+void SceneFile::CreateObjects(std::vector<GameObject*> &objects)const
+{
+	// The packed header of each object follows the list of object sizes
+	const float *packed = this->gpuData + 1 + this->nrObjects;
+	const char *record = this->objectData;
+
+	objects.reserve(objects.size() + this->nrObjects);
+	for (uint32_t i = 0; i < this->nrObjects; i++)
+	{
+		GameObject *go = new GameObject();
+
+		go->nrVerts = packed[0];
+		go->isPortal = packed[1];
+		go->portalPosition = Vec3(packed[2], packed[3], packed[4]);
+		go->portalNormal = Vec3(packed[5], packed[6], packed[7]);
+		go->color = Vec3(packed[8], packed[9], packed[10]);
+		go->aabbMin = Vec3(packed[11], packed[12], packed[13]);
+		go->aabbMax = Vec3(packed[14], packed[15], packed[16]);
+
+		go->cameraRotation = (int32_t)ReadUint(record);
+		uint32_t nrPositions = ReadUint(record + 4);
+		uint32_t nrIndices = ReadUint(record + 8);
+
+		const float *transform = (const float*)(record + 12);
+		for (int j = 0; j < 16; j++)
+			go->transform[j] = transform[j];
+		go->localTransform = go->transform;
+
+		const float *localAABB = transform + 16;
+		go->localMin = Vec3(localAABB[0], localAABB[1], localAABB[2]);
+		go->localMax = Vec3(localAABB[3], localAABB[4], localAABB[5]);
+
+		const float *xs = localAABB + 6;
+		const float *ys = xs + nrPositions;
+		const float *zs = ys + nrPositions;
+		go->xs.assign(xs, xs + nrPositions);
+		go->ys.assign(ys, ys + nrPositions);
+		go->zs.assign(zs, zs + nrPositions);
+
+		const int32_t *indices = (const int32_t*)(zs + nrPositions);
+		go->indices.assign(indices, indices + nrIndices);
+
+		objects.push_back(go);
+
+		packed += (int)this->gpuData[1 + i];
+		record += RecordHeaderSize + ((size_t)nrPositions * 3 + nrIndices) * 4;
+	}
+}
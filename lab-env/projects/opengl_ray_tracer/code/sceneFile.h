@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "gameObject.h"
+#include "mappedFile.h"
+
+
+// Binary scene with the objects already packed in the SceneBuffer layout, so
+// the GPU buffer is uploaded straight from the mapped file
+class SceneFile
+{
+public:
+
+	SceneFile();
+	~SceneFile();
+
+	// Pack the objects and write them with what the CPU side needs to
+	// recreate them
+	static bool Write(const char *filename, const std::vector<GameObject*> &objects);
+
+	// Map the file and check that it is complete
+	bool Open(const char *filename);
+	void Close();
+
+	// The packed objects, nullptr when no file is open
+	const float* GpuData()const;
+	size_t GpuSize()const;
+
+	// Recreate the objects for collision and the portals
+	void CreateObjects(std::vector<GameObject*> &objects)const;
+
+private:
+
+	MappedFile file;
+	const float *gpuData = nullptr;
+	const char *objectData = nullptr;
+	uint32_t nrObjects = 0;
+	uint32_t nrGpuFloats = 0;
+};
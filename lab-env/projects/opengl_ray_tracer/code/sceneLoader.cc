@@ -0,0 +1,72 @@
+#include "sceneLoader.h"
+
+
+SceneLoader::SceneLoader()
+{}
+
+SceneLoader::~SceneLoader()
+{
+	// The window can close before loading is done
+	if (this->thread.joinable())
+		this->thread.join();
+
+	for (size_t i = 0; i < this->staticQueue.size(); i++)
+		delete this->staticQueue[i];
+	for (size_t i = 0; i < this->dynamicQueue.size(); i++)
+		delete this->dynamicQueue[i];
+}
+
+
+void SceneLoader::Start(const std::function<void(SceneLoader&)> &load)
+{
+	this->finished = false;
+	this->thread = std::thread([this, load]()
+	{
+		load(*this);
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->finished = true;
+		this->finishedCondition.notify_all();
+	});
+}
+
+
+void SceneLoader::Add(GameObject *go, const bool isStatic)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (isStatic)
+		this->staticQueue.push_back(go);
+	else
+		this->dynamicQueue.push_back(go);
+}
+
+void SceneLoader::Add(const std::vector<GameObject*> &objects, const bool isStatic)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<GameObject*> &queue = isStatic ? this->staticQueue : this->dynamicQueue;
+	queue.insert(queue.end(), objects.begin(), objects.end());
+}
+
+
+bool SceneLoader::Take(std::vector<GameObject*> &staticGO, std::vector<GameObject*> &dynamicGO)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	staticGO.insert(staticGO.end(), this->staticQueue.begin(), this->staticQueue.end());
+	dynamicGO.insert(dynamicGO.end(), this->dynamicQueue.begin(), this->dynamicQueue.end());
+	this->staticQueue.clear();
+	this->dynamicQueue.clear();
+
+	return this->finished;
+}
+
+
+void SceneLoader::Wait()
+{
+	// Nothing to wait for before Start
+	if (!this->thread.joinable())
+		return;
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->finishedCondition.wait(lock, [this]() { return this->finished; });
+}
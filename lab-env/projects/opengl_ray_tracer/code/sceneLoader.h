@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "gameObject.h"
+
+
+// Runs the scene loading on a worker thread. Objects are queued as they are
+// finished and the GL thread takes them once per frame, so the window can
+// render while the rest of the scene is still loading
+class SceneLoader
+{
+public:
+
+	SceneLoader();
+	~SceneLoader();
+
+	// Call load on the worker thread, it adds the objects as they are done
+	void Start(const std::function<void(SceneLoader&)> &load);
+
+	// Called by the load function
+	void Add(GameObject *go, const bool isStatic);
+	void Add(const std::vector<GameObject*> &objects, const bool isStatic);
+
+	// Append the objects that arrived since the last call. Returns true once
+	// the load function has returned and every object has been taken
+	bool Take(std::vector<GameObject*> &staticGO, std::vector<GameObject*> &dynamicGO);
+
+	// Block until the load function has returned
+	void Wait();
+
+private:
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable finishedCondition;
+
+	std::vector<GameObject*> staticQueue;
+	std::vector<GameObject*> dynamicQueue;
+	bool finished = false;
+};
@@ -0,0 +1,117 @@
+#include "shaderCounters.h"
+
+
+ShaderCounters::ShaderCounters()
+{
+	for (int i = 0; i < NrBuffers; i++)
+	{
+		this->buffers[i] = 0;
+		this->fences[i] = 0;
+		this->frames[i] = -1;
+	}
+}
+
+ShaderCounters::~ShaderCounters()
+{}
+
+
+void ShaderCounters::Init(const int nrCounters, const GLuint binding)
+{
+	this->nrCounters = nrCounters;
+	this->binding = binding;
+	this->values.assign(nrCounters, 0);
+
+	std::vector<GLuint> zero(nrCounters, 0);
+
+	glGenBuffers(NrBuffers, this->buffers);
+	for (int i = 0; i < NrBuffers; i++)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->buffers[i]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * nrCounters, zero.data(), GL_DYNAMIC_READ);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// Keep something bound even in frames that don't use the counters
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, this->binding, this->buffers[0]);
+}
+
+void ShaderCounters::Release()
+{
+	for (int i = 0; i < NrBuffers; i++)
+	{
+		if (this->fences[i] != 0)
+			glDeleteSync(this->fences[i]);
+		this->fences[i] = 0;
+	}
+
+	// Names that are 0 or already deleted are ignored
+	glDeleteBuffers(NrBuffers, this->buffers);
+	for (int i = 0; i < NrBuffers; i++)
+		this->buffers[i] = 0;
+}
+
+void ShaderCounters::Bind(const long long frame)
+{
+	// The GPU is more than NrBuffers frames behind, drop that result
+	if (this->fences[this->current] != 0)
+	{
+		glDeleteSync(this->fences[this->current]);
+		this->fences[this->current] = 0;
+	}
+
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->buffers[this->current]);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, this->binding, this->buffers[this->current]);
+	this->frames[this->current] = frame;
+}
+
+void ShaderCounters::Submit()
+{
+	// Shader writes have to be visible to glGetBufferSubData once the fence is signaled
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	this->fences[this->current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	this->current = (this->current + 1) % NrBuffers;
+}
+
+bool ShaderCounters::Poll()
+{
+	bool newValues = false;
+
+	// Submitted in ring order, so the oldest one is the first after current
+	for (int i = 0; i < NrBuffers; i++)
+	{
+		int index = (this->current + i) % NrBuffers;
+		if (this->fences[index] == 0)
+			continue;
+
+		// Zero timeout, only check if the GPU is done
+		GLenum status = glClientWaitSync(this->fences[index], 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->buffers[index]);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint) * this->nrCounters, this->values.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		glDeleteSync(this->fences[index]);
+		this->fences[index] = 0;
+		this->frame = this->frames[index];
+		newValues = true;
+	}
+
+	return newValues;
+}
+
+GLuint ShaderCounters::Get(const int i)const
+{
+	return this->values[i];
+}
+
+long long ShaderCounters::GetFrame()const
+{
+	return this->frame;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#ifndef GL_INCLUDED
+#define GL_INCLUDED
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#endif
+
+
+// A block of uint counters that the compute shader adds to. Each frame gets
+// its own buffer out of a small ring and a fence after the dispatch, so the
+// results are read a frame or two later without waiting for the GPU.
+class ShaderCounters
+{
+public:
+
+	static const int NrBuffers = 3;
+
+	ShaderCounters();
+	~ShaderCounters();
+
+	void Init(const int nrCounters, const GLuint binding);
+	// Delete the buffers and fences, while the context is still current
+	void Release();
+
+	// Bind a cleared buffer to the storage binding for the coming dispatch
+	// of the given frame
+	void Bind(const long long frame);
+	// Mark the buffer as written by the dispatch that was just issued
+	void Submit();
+
+	// Read the oldest finished buffer, returns true if new values arrived
+	bool Poll();
+
+	GLuint Get(const int i)const;
+	// Frame the values were counted in, -1 before the first result
+	long long GetFrame()const;
+
+private:
+
+	GLuint buffers[NrBuffers];
+	GLsync fences[NrBuffers];
+	long long frames[NrBuffers];
+	int current = 0;
+	int nrCounters = 0;
+	GLuint binding = 0;
+
+	std::vector<GLuint> values;
+	long long frame = -1;
+};
@@ -147,6 +147,13 @@ void ShaderResource::GetUniformHandles()
 	// Texture
 	handle = glGetUniformLocation(program, "diffuseTextureSampler");
 	uniformLocations.insert(std::pair<std::string, GLuint>("diffuseTextureSampler", handle));
+
+
+	// Heatmap
+	handle = glGetUniformLocation(program, "channel");
+	uniformLocations.insert(std::pair<std::string, GLuint>("channel", handle));
+	handle = glGetUniformLocation(program, "maxCost");
+	uniformLocations.insert(std::pair<std::string, GLuint>("maxCost", handle));
 }
 
 
@@ -0,0 +1,557 @@
+#include "simdKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define RT_X86 1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
+
+// GCC and Clang only allow intrinsics in functions compiled for the
+// instruction set, MSVC allows them everywhere
+#if defined(__GNUC__)
+	#define RT_TARGET(x) __attribute__((target(x)))
+#else
+	#define RT_TARGET(x)
+#endif
+
+
+static const float Epsilon = 0.00001f;
+
+
+TriangleSoA::TriangleSoA()
+{}
+
+TriangleSoA::~TriangleSoA()
+{}
+
+
+void TriangleSoA::Clear()
+{
+	this->ax.clear(); this->ay.clear(); this->az.clear();
+	this->abx.clear(); this->aby.clear(); this->abz.clear();
+	this->acx.clear(); this->acy.clear(); this->acz.clear();
+}
+
+int TriangleSoA::Size()const
+{
+	return this->ax.size();
+}
+
+void TriangleSoA::Add(const Vec3 &a, const Vec3 &ab, const Vec3 &ac)
+{
+	this->ax.push_back(a.x); this->ay.push_back(a.y); this->az.push_back(a.z);
+	this->abx.push_back(ab.x); this->aby.push_back(ab.y); this->abz.push_back(ab.z);
+	this->acx.push_back(ac.x); this->acy.push_back(ac.y); this->acz.push_back(ac.z);
+}
+
+void TriangleSoA::Pad()
+{
+	// Zero edges give a zero determinant, which is always a miss
+	while (this->Size() % Width != 0)
+		this->Add(Vec3(), Vec3(), Vec3());
+}
+
+
+
+BoxSoA::BoxSoA()
+{}
+
+BoxSoA::~BoxSoA()
+{}
+
+
+void BoxSoA::Clear()
+{
+	this->minX.clear(); this->minY.clear(); this->minZ.clear();
+	this->maxX.clear(); this->maxY.clear(); this->maxZ.clear();
+}
+
+int BoxSoA::Size()const
+{
+	return this->minX.size();
+}
+
+void BoxSoA::Add(const Vec3 &min, const Vec3 &max)
+{
+	this->minX.push_back(min.x); this->minY.push_back(min.y); this->minZ.push_back(min.z);
+	this->maxX.push_back(max.x); this->maxY.push_back(max.y); this->maxZ.push_back(max.z);
+}
+
+void BoxSoA::Pad()
+{
+	while (this->Size() % Width != 0)
+		this->Add(Vec3(1.0f, 1.0f, 1.0f), Vec3(-1.0f, -1.0f, -1.0f));
+}
+
+
+
+// Scalar
+// ----------------------------------------------------------------------------
+
+// Same NaN handling as minps/maxps, the second operand wins
+static float Min(const float a, const float b)
+{
+	return (a < b) ? a : b;
+}
+
+static float Max(const float a, const float b)
+{
+	return (a > b) ? a : b;
+}
+
+static void BoxesScalar(const BoxSoA &boxes, const int first, const Vec3 &origin, const Vec3 &invDir,
+						float *tNear, float *tFar)
+{
+	for (int lane = 0; lane < BoxSoA::Width; lane++)
+	{
+		int i = first + lane;
+		float tMinX = (boxes.minX[i] - origin.x) * invDir.x, tMaxX = (boxes.maxX[i] - origin.x) * invDir.x;
+		float tMinY = (boxes.minY[i] - origin.y) * invDir.y, tMaxY = (boxes.maxY[i] - origin.y) * invDir.y;
+		float tMinZ = (boxes.minZ[i] - origin.z) * invDir.z, tMaxZ = (boxes.maxZ[i] - origin.z) * invDir.z;
+
+		tNear[lane] = Max(Max(Min(tMinX, tMaxX), Min(tMinY, tMaxY)), Min(tMinZ, tMaxZ));
+		tFar[lane] = Min(Min(Max(tMinX, tMaxX), Max(tMinY, tMaxY)), Max(tMinZ, tMaxZ));
+	}
+}
+
+// Same operations in the same order as Vec3::Cross/Dot in the CPU tracer, so
+// every kernel gives bit-identical results
+static bool IntersectScalar(const TriangleSoA &tris, const int i, const Vec3 &o, const Vec3 &d,
+							float &t, float &u, float &v)
+{
+	float abx = tris.abx[i], aby = tris.aby[i], abz = tris.abz[i];
+	float acx = tris.acx[i], acy = tris.acy[i], acz = tris.acz[i];
+
+	float px = d.y * acz - d.z * acy;
+	float py = d.z * acx - d.x * acz;
+	float pz = d.x * acy - d.y * acx;
+
+	float det = abx * px + aby * py + abz * pz;
+	if (det < Epsilon)
+		return false;
+
+	float invDet = 1.0f / det;
+
+	float tx = o.x - tris.ax[i];
+	float ty = o.y - tris.ay[i];
+	float tz = o.z - tris.az[i];
+
+	u = (tx * px + ty * py + tz * pz) * invDet;
+	if (u < 0 || u > 1)
+		return false;
+
+	float qx = ty * abz - tz * aby;
+	float qy = tz * abx - tx * abz;
+	float qz = tx * aby - ty * abx;
+
+	v = (d.x * qx + d.y * qy + d.z * qz) * invDet;
+	if (v < 0 || u + v > 1)
+		return false;
+
+	t = (acx * qx + acy * qy + acz * qz) * invDet;
+	return true;
+}
+
+static int ClosestScalar(const TriangleSoA &tris, const int first, const int count,
+						 const Vec3 &origin, const Vec3 &dir, float tMax, float &t, float &u, float &v)
+{
+	int hit = -1;
+	float ti, ui, vi;
+
+	for (int i = first; i < first + count; i++)
+	{
+		if (IntersectScalar(tris, i, origin, dir, ti, ui, vi) && ti < tMax && ti > 0.0f)
+		{
+			tMax = ti;
+			t = ti; u = ui; v = vi;
+			hit = i;
+		}
+	}
+
+	return hit;
+}
+
+static bool AnyScalar(const TriangleSoA &tris, const int first, const int count,
+					  const Vec3 &origin, const Vec3 &dir)
+{
+	float t, u, v;
+	for (int i = first; i < first + count; i++)
+	{
+		if (IntersectScalar(tris, i, origin, dir, t, u, v) && t > 0.0f)
+			return true;
+	}
+
+	return false;
+}
+
+// Go through the lanes that passed in index order, so ties go to the lowest
+// index like in the scalar loop
+static int PickClosest(const int mask, const int base, const int width, const float *t, const float *u, const float *v,
+					   float &tMax, float &bestT, float &bestU, float &bestV)
+{
+	int hit = -1;
+	for (int lane = 0; lane < width; lane++)
+	{
+		if ((mask & (1 << lane)) && t[lane] < tMax)
+		{
+			tMax = t[lane];
+			bestT = t[lane]; bestU = u[lane]; bestV = v[lane];
+			hit = base + lane;
+		}
+	}
+
+	return hit;
+}
+
+
+
+#ifdef RT_X86
+
+// SSE4.1, 4 triangles per step
+// ----------------------------------------------------------------------------
+
+// Lanes hit at t > 0, writes t, u and v of every lane
+RT_TARGET("sse4.1")
+static int Intersect4(const TriangleSoA &tris, const int i, const __m128 o[3], const __m128 d[3],
+					  __m128 &t, __m128 &u, __m128 &v)
+{
+	__m128 abx = _mm_loadu_ps(&tris.abx[i]), aby = _mm_loadu_ps(&tris.aby[i]), abz = _mm_loadu_ps(&tris.abz[i]);
+	__m128 acx = _mm_loadu_ps(&tris.acx[i]), acy = _mm_loadu_ps(&tris.acy[i]), acz = _mm_loadu_ps(&tris.acz[i]);
+
+	__m128 px = _mm_sub_ps(_mm_mul_ps(d[1], acz), _mm_mul_ps(d[2], acy));
+	__m128 py = _mm_sub_ps(_mm_mul_ps(d[2], acx), _mm_mul_ps(d[0], acz));
+	__m128 pz = _mm_sub_ps(_mm_mul_ps(d[0], acy), _mm_mul_ps(d[1], acx));
+
+	__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abx, px), _mm_mul_ps(aby, py)), _mm_mul_ps(abz, pz));
+	__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+	__m128 tx = _mm_sub_ps(o[0], _mm_loadu_ps(&tris.ax[i]));
+	__m128 ty = _mm_sub_ps(o[1], _mm_loadu_ps(&tris.ay[i]));
+	__m128 tz = _mm_sub_ps(o[2], _mm_loadu_ps(&tris.az[i]));
+
+	u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), invDet);
+
+	__m128 qx = _mm_sub_ps(_mm_mul_ps(ty, abz), _mm_mul_ps(tz, aby));
+	__m128 qy = _mm_sub_ps(_mm_mul_ps(tz, abx), _mm_mul_ps(tx, abz));
+	__m128 qz = _mm_sub_ps(_mm_mul_ps(tx, aby), _mm_mul_ps(ty, abx));
+
+	v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(d[0], qx), _mm_mul_ps(d[1], qy)), _mm_mul_ps(d[2], qz)), invDet);
+	t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(acx, qx), _mm_mul_ps(acy, qy)), _mm_mul_ps(acz, qz)), invDet);
+
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1.0f);
+
+	// Ordered compares, so NaN lanes fail like in the scalar version
+	__m128 valid = _mm_cmpge_ps(det, _mm_set1_ps(Epsilon));
+	valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+	valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+	valid = _mm_and_ps(valid, _mm_cmpgt_ps(t, zero));
+
+	return _mm_movemask_ps(valid);
+}
+
+RT_TARGET("sse4.1")
+static int ClosestSSE4(const TriangleSoA &tris, const int first, const int count,
+					   const Vec3 &origin, const Vec3 &dir, float tMax, float &t, float &u, float &v)
+{
+	__m128 o[3] = { _mm_set1_ps(origin.x), _mm_set1_ps(origin.y), _mm_set1_ps(origin.z) };
+	__m128 d[3] = { _mm_set1_ps(dir.x), _mm_set1_ps(dir.y), _mm_set1_ps(dir.z) };
+
+	int hit = -1;
+	for (int i = first; i < first + count; i += 4)
+	{
+		__m128 t4, u4, v4;
+		int mask = Intersect4(tris, i, o, d, t4, u4, v4);
+		mask &= _mm_movemask_ps(_mm_cmplt_ps(t4, _mm_set1_ps(tMax)));
+		if (mask == 0)
+			continue;
+
+		float ts[4], us[4], vs[4];
+		_mm_storeu_ps(ts, t4);
+		_mm_storeu_ps(us, u4);
+		_mm_storeu_ps(vs, v4);
+
+		int lane = PickClosest(mask, i, 4, ts, us, vs, tMax, t, u, v);
+		if (lane >= 0)
+			hit = lane;
+	}
+
+	return hit;
+}
+
+RT_TARGET("sse4.1")
+static void BoxesSSE4(const BoxSoA &boxes, const int first, const Vec3 &origin, const Vec3 &invDir,
+					  float *tNear, float *tFar)
+{
+	__m128 o[3] = { _mm_set1_ps(origin.x), _mm_set1_ps(origin.y), _mm_set1_ps(origin.z) };
+	__m128 inv[3] = { _mm_set1_ps(invDir.x), _mm_set1_ps(invDir.y), _mm_set1_ps(invDir.z) };
+
+	for (int lane = 0; lane < BoxSoA::Width; lane += 4)
+	{
+		int i = first + lane;
+		__m128 tMinX = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&boxes.minX[i]), o[0]), inv[0]);
+		__m128 tMaxX = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&boxes.maxX[i]), o[0]), inv[0]);
+		__m128 tMinY = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&boxes.minY[i]), o[1]), inv[1]);
+		__m128 tMaxY = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&boxes.maxY[i]), o[1]), inv[1]);
+		__m128 tMinZ = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&boxes.minZ[i]), o[2]), inv[2]);
+		__m128 tMaxZ = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&boxes.maxZ[i]), o[2]), inv[2]);
+
+		__m128 n = _mm_max_ps(_mm_max_ps(_mm_min_ps(tMinX, tMaxX), _mm_min_ps(tMinY, tMaxY)), _mm_min_ps(tMinZ, tMaxZ));
+		__m128 f = _mm_min_ps(_mm_min_ps(_mm_max_ps(tMinX, tMaxX), _mm_max_ps(tMinY, tMaxY)), _mm_max_ps(tMinZ, tMaxZ));
+		_mm_storeu_ps(tNear + lane, n);
+		_mm_storeu_ps(tFar + lane, f);
+	}
+}
+
+RT_TARGET("sse4.1")
+static bool AnySSE4(const TriangleSoA &tris, const int first, const int count,
+					const Vec3 &origin, const Vec3 &dir)
+{
+	__m128 o[3] = { _mm_set1_ps(origin.x), _mm_set1_ps(origin.y), _mm_set1_ps(origin.z) };
+	__m128 d[3] = { _mm_set1_ps(dir.x), _mm_set1_ps(dir.y), _mm_set1_ps(dir.z) };
+
+	for (int i = first; i < first + count; i += 4)
+	{
+		__m128 t4, u4, v4;
+		if (Intersect4(tris, i, o, d, t4, u4, v4) != 0)
+			return true;
+	}
+
+	return false;
+}
+
+
+
+// AVX2, 8 triangles per step
+// ----------------------------------------------------------------------------
+
+// No FMA in the target on purpose, a fused multiply-add would round
+// differently from the scalar kernel
+RT_TARGET("avx2")
+static int Intersect8(const TriangleSoA &tris, const int i, const __m256 o[3], const __m256 d[3],
+					  __m256 &t, __m256 &u, __m256 &v)
+{
+	__m256 abx = _mm256_loadu_ps(&tris.abx[i]), aby = _mm256_loadu_ps(&tris.aby[i]), abz = _mm256_loadu_ps(&tris.abz[i]);
+	__m256 acx = _mm256_loadu_ps(&tris.acx[i]), acy = _mm256_loadu_ps(&tris.acy[i]), acz = _mm256_loadu_ps(&tris.acz[i]);
+
+	__m256 px = _mm256_sub_ps(_mm256_mul_ps(d[1], acz), _mm256_mul_ps(d[2], acy));
+	__m256 py = _mm256_sub_ps(_mm256_mul_ps(d[2], acx), _mm256_mul_ps(d[0], acz));
+	__m256 pz = _mm256_sub_ps(_mm256_mul_ps(d[0], acy), _mm256_mul_ps(d[1], acx));
+
+	__m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(abx, px), _mm256_mul_ps(aby, py)), _mm256_mul_ps(abz, pz));
+	__m256 invDet = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+
+	__m256 tx = _mm256_sub_ps(o[0], _mm256_loadu_ps(&tris.ax[i]));
+	__m256 ty = _mm256_sub_ps(o[1], _mm256_loadu_ps(&tris.ay[i]));
+	__m256 tz = _mm256_sub_ps(o[2], _mm256_loadu_ps(&tris.az[i]));
+
+	u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tx, px), _mm256_mul_ps(ty, py)), _mm256_mul_ps(tz, pz)), invDet);
+
+	__m256 qx = _mm256_sub_ps(_mm256_mul_ps(ty, abz), _mm256_mul_ps(tz, aby));
+	__m256 qy = _mm256_sub_ps(_mm256_mul_ps(tz, abx), _mm256_mul_ps(tx, abz));
+	__m256 qz = _mm256_sub_ps(_mm256_mul_ps(tx, aby), _mm256_mul_ps(ty, abx));
+
+	v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(d[0], qx), _mm256_mul_ps(d[1], qy)), _mm256_mul_ps(d[2], qz)), invDet);
+	t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(acx, qx), _mm256_mul_ps(acy, qy)), _mm256_mul_ps(acz, qz)), invDet);
+
+	__m256 zero = _mm256_setzero_ps();
+	__m256 one = _mm256_set1_ps(1.0f);
+
+	__m256 valid = _mm256_cmp_ps(det, _mm256_set1_ps(Epsilon), _CMP_GE_OQ);
+	valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+	valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ),
+											   _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+	valid = _mm256_and_ps(valid, _mm256_cmp_ps(t, zero, _CMP_GT_OQ));
+
+	return _mm256_movemask_ps(valid);
+}
+
+RT_TARGET("avx2")
+static int ClosestAVX2(const TriangleSoA &tris, const int first, const int count,
+					   const Vec3 &origin, const Vec3 &dir, float tMax, float &t, float &u, float &v)
+{
+	__m256 o[3] = { _mm256_set1_ps(origin.x), _mm256_set1_ps(origin.y), _mm256_set1_ps(origin.z) };
+	__m256 d[3] = { _mm256_set1_ps(dir.x), _mm256_set1_ps(dir.y), _mm256_set1_ps(dir.z) };
+
+	int hit = -1;
+	for (int i = first; i < first + count; i += 8)
+	{
+		__m256 t8, u8, v8;
+		int mask = Intersect8(tris, i, o, d, t8, u8, v8);
+		mask &= _mm256_movemask_ps(_mm256_cmp_ps(t8, _mm256_set1_ps(tMax), _CMP_LT_OQ));
+		if (mask == 0)
+			continue;
+
+		float ts[8], us[8], vs[8];
+		_mm256_storeu_ps(ts, t8);
+		_mm256_storeu_ps(us, u8);
+		_mm256_storeu_ps(vs, v8);
+
+		int lane = PickClosest(mask, i, 8, ts, us, vs, tMax, t, u, v);
+		if (lane >= 0)
+			hit = lane;
+	}
+
+	return hit;
+}
+
+RT_TARGET("avx2")
+static void BoxesAVX2(const BoxSoA &boxes, const int first, const Vec3 &origin, const Vec3 &invDir,
+					  float *tNear, float *tFar)
+{
+	__m256 o[3] = { _mm256_set1_ps(origin.x), _mm256_set1_ps(origin.y), _mm256_set1_ps(origin.z) };
+	__m256 inv[3] = { _mm256_set1_ps(invDir.x), _mm256_set1_ps(invDir.y), _mm256_set1_ps(invDir.z) };
+
+	__m256 tMinX = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&boxes.minX[first]), o[0]), inv[0]);
+	__m256 tMaxX = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&boxes.maxX[first]), o[0]), inv[0]);
+	__m256 tMinY = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&boxes.minY[first]), o[1]), inv[1]);
+	__m256 tMaxY = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&boxes.maxY[first]), o[1]), inv[1]);
+	__m256 tMinZ = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&boxes.minZ[first]), o[2]), inv[2]);
+	__m256 tMaxZ = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&boxes.maxZ[first]), o[2]), inv[2]);
+
+	__m256 n = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(tMinX, tMaxX), _mm256_min_ps(tMinY, tMaxY)), _mm256_min_ps(tMinZ, tMaxZ));
+	__m256 f = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(tMinX, tMaxX), _mm256_max_ps(tMinY, tMaxY)), _mm256_max_ps(tMinZ, tMaxZ));
+	_mm256_storeu_ps(tNear, n);
+	_mm256_storeu_ps(tFar, f);
+}
+
+RT_TARGET("avx2")
+static bool AnyAVX2(const TriangleSoA &tris, const int first, const int count,
+					const Vec3 &origin, const Vec3 &dir)
+{
+	__m256 o[3] = { _mm256_set1_ps(origin.x), _mm256_set1_ps(origin.y), _mm256_set1_ps(origin.z) };
+	__m256 d[3] = { _mm256_set1_ps(dir.x), _mm256_set1_ps(dir.y), _mm256_set1_ps(dir.z) };
+
+	for (int i = first; i < first + count; i += 8)
+	{
+		__m256 t8, u8, v8;
+		if (Intersect8(tris, i, o, d, t8, u8, v8) != 0)
+			return true;
+	}
+
+	return false;
+}
+
+#endif // RT_X86
+
+
+
+// Dispatch
+// ----------------------------------------------------------------------------
+
+typedef int (*ClosestFunction)(const TriangleSoA&, const int, const int, const Vec3&, const Vec3&, float, float&, float&, float&);
+typedef bool (*AnyFunction)(const TriangleSoA&, const int, const int, const Vec3&, const Vec3&);
+typedef void (*BoxesFunction)(const BoxSoA&, const int, const Vec3&, const Vec3&, float*, float*);
+
+static SimdKernel::Type selectedType = SimdKernel::Scalar;
+static ClosestFunction closestFunction = ClosestScalar;
+static AnyFunction anyFunction = AnyScalar;
+static BoxesFunction boxesFunction = BoxesScalar;
+
+// Pick the best kernel before main runs
+static bool detected = (SimdKernel::Select(SimdKernel::Detect()), true);
+
+
+SimdKernel::SimdKernel()
+{}
+
+SimdKernel::~SimdKernel()
+{}
+
+
+SimdKernel::Type SimdKernel::Detect()
+{
+#if defined(RT_X86) && defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return AVX2;
+	if (__builtin_cpu_supports("sse4.1"))
+		return SSE4;
+
+#elif defined(RT_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool sse41 = (info[2] & (1 << 19)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+
+	// AVX state also has to be enabled by the OS
+	bool avx2 = false;
+	if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+
+	if (avx2)
+		return AVX2;
+	if (sse41)
+		return SSE4;
+#endif
+
+	return Scalar;
+}
+
+void SimdKernel::Select(const Type type)
+{
+	Type best = Detect();
+	selectedType = (type <= best) ? type : best;
+
+	switch (selectedType)
+	{
+#ifdef RT_X86
+	case AVX2:
+		closestFunction = ClosestAVX2;
+		anyFunction = AnyAVX2;
+		boxesFunction = BoxesAVX2;
+		break;
+	case SSE4:
+		closestFunction = ClosestSSE4;
+		anyFunction = AnySSE4;
+		boxesFunction = BoxesSSE4;
+		break;
+#endif
+	default:
+		closestFunction = ClosestScalar;
+		anyFunction = AnyScalar;
+		boxesFunction = BoxesScalar;
+		break;
+	}
+}
+
+SimdKernel::Type SimdKernel::Selected()
+{
+	return selectedType;
+}
+
+const char* SimdKernel::Name(const Type type)
+{
+	switch (type)
+	{
+	case AVX2: return "avx2";
+	case SSE4: return "sse4";
+	default: return "scalar";
+	}
+}
+
+int SimdKernel::Closest(const TriangleSoA &tris, const int first, const int count,
+							const Vec3 &origin, const Vec3 &dir, float tMax, float &t, float &u, float &v)
+{
+	return closestFunction(tris, first, count, origin, dir, tMax, t, u, v);
+}
+
+bool SimdKernel::Any(const TriangleSoA &tris, const int first, const int count,
+						 const Vec3 &origin, const Vec3 &dir)
+{
+	return anyFunction(tris, first, count, origin, dir);
+}
+
+void SimdKernel::Boxes(const BoxSoA &boxes, const int first, const Vec3 &origin, const Vec3 &invDir,
+					   float *tNear, float *tFar)
+{
+	boxesFunction(boxes, first, origin, invDir, tNear, tFar);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+
+#include "mathVec3.h"
+
+
+// Triangles stored as one array per component so a ray can be tested against
+// several of them at once. Every object's range is padded to a multiple of
+// Width with degenerate triangles that can never be hit
+class TriangleSoA
+{
+public:
+
+	static const int Width = 8;
+
+	// First vertex and the two edges used by Möller-Trumbore
+	std::vector<float> ax, ay, az;
+	std::vector<float> abx, aby, abz;
+	std::vector<float> acx, acy, acz;
+
+
+	TriangleSoA();
+	~TriangleSoA();
+
+	void Clear();
+	int Size()const;
+
+	void Add(const Vec3 &a, const Vec3 &ab, const Vec3 &ac);
+
+	// Fill up to the next multiple of Width
+	void Pad();
+};
+
+
+// Object bounds in the same layout, padded with empty boxes
+class BoxSoA
+{
+public:
+
+	static const int Width = 8;
+
+	std::vector<float> minX, minY, minZ;
+	std::vector<float> maxX, maxY, maxZ;
+
+
+	BoxSoA();
+	~BoxSoA();
+
+	void Clear();
+	int Size()const;
+
+	void Add(const Vec3 &min, const Vec3 &max);
+	void Pad();
+};
+
+
+// 1 ray against 4 (SSE4.1) or 8 (AVX2) triangles or boxes, picked at runtime
+// from what the CPU supports. All versions give the same results as the scalar one
+class SimdKernel
+{
+public:
+
+	enum Type
+	{
+		Scalar,
+		SSE4,
+		AVX2
+	};
+
+
+	SimdKernel();
+	~SimdKernel();
+
+	// Best kernel for this CPU
+	static Type Detect();
+
+	// Use a specific kernel, falls back to Detect() if the CPU lacks support
+	static void Select(const Type type);
+	static Type Selected();
+	static const char* Name(const Type type);
+
+	// Closest triangle in [first, first+count) hit at 0 < t < tMax. Returns
+	// its index and writes t, u and v, or returns -1 if nothing is hit
+	static int Closest(const TriangleSoA &tris, const int first, const int count,
+					   const Vec3 &origin, const Vec3 &dir, float tMax, float &t, float &u, float &v);
+
+	// True if any triangle in [first, first+count) is hit in front of the origin
+	static bool Any(const TriangleSoA &tris, const int first, const int count,
+					const Vec3 &origin, const Vec3 &dir);
+
+	// Slab test of BoxSoA::Width boxes starting at first (a multiple of Width).
+	// The box is hit if tNear <= tFar and tFar > 0
+	static void Boxes(const BoxSoA &boxes, const int first, const Vec3 &origin, const Vec3 &invDir,
+					  float *tNear, float *tFar);
+};
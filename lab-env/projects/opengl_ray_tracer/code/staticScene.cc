@@ -0,0 +1,178 @@
+#include "staticScene.h"
+#include "objParser.h"
+
+
+constexpr const char *StaticScene::SceneFile;
+constexpr const char *StaticScene::ConvertedFile;
+
+StaticScene::StaticScene()
+{}
+
+StaticScene::~StaticScene()
+{}
+
+
+void StaticScene::Create(std::vector<GameObject*> &objects, ThreadPool &pool)
+{
+	GameObject *obj;
+	size_t first = objects.size();
+
+
+	// Large scenes are parsed on all threads
+	ObjParser::LoadScene(SceneFile, objects, pool);
+
+
+	// Left Arch
+	{
+		// Front
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(-5, 1, 0.499f), 180);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(-6-50, -2, 3.999f);
+		obj->portalNormal = Vec3(0, 0, -1);
+		objects.push_back(obj);
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(-6-50, -2, -4), 180);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(-5, 1, -0.50f);
+		obj->portalNormal = Vec3(0, 0, -1);
+		objects.push_back(obj);
+
+		// Back
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(-5, 1, -0.499f), 0);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(-6-50, -2, -3.999f);
+		obj->portalNormal = Vec3(0, 0, 1);
+		objects.push_back(obj);
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(-6-50, -2, 4), 0);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(-5, 1, 0.50f);
+		obj->portalNormal = Vec3(0, 0, 1);
+		objects.push_back(obj);
+	}
+
+
+	// Right Arch
+	{
+		// Left
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(7.001f, 1, 0), 90);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(-3.999f-50, -2, 6);
+		obj->portalNormal = Vec3(1, 0, 0);
+		obj->cameraRotation = 0;
+		objects.push_back(obj);
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(-4-50, -2, 6), 270);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(7, 1, 0);
+		obj->portalNormal = Vec3(-1, 0, 0);
+		obj->cameraRotation = 0;
+		objects.push_back(obj);
+
+
+		// Mirror at the back of the corridor
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(4-50, -2, 6), 90);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(3.999f-50, -2, 6);
+		obj->portalNormal = Vec3(-1, 0, 0);
+		obj->cameraRotation = 180;
+		objects.push_back(obj);
+	}
+
+
+	// Back Arch
+	{
+		// Left
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(-1.5f, 1, -6), 90);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(1.501f, 1, -6);
+		obj->portalNormal = Vec3(1, 0, 0);
+		objects.push_back(obj);
+
+		// Right
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(1.5f, 1, -6), 270);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(-1.501f, 1, -6);
+		obj->portalNormal = Vec3(-1, 0, 0);
+		objects.push_back(obj);
+	}
+
+
+	// Front Arch
+	{
+		// Enter
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(0, 1, 7.001f), 0);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(3-50, -2, -1.999f);
+		obj->portalNormal = Vec3(0, 0, 1);
+		obj->cameraRotation = 0;
+		objects.push_back(obj);
+
+		// Exit
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(3-50, -2, -2), 180);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(0, 1, 7);
+		obj->portalNormal = Vec3(0, 0, -1);
+		obj->cameraRotation = 0;
+		objects.push_back(obj);
+
+		// Loop
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(-3-50, -2, 0), 180);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(0-50, -2, 3);
+		obj->portalNormal = Vec3(-1, 0, 0);
+		obj->cameraRotation = 90;
+		objects.push_back(obj);
+
+	}
+
+	
+	// 4D Cube
+	{
+		// Back portal
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(0, 1, -1.0001f), 0);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(0-50, -5, -1.0001f-5);
+		obj->portalNormal = Vec3(0, 0, 1);
+		objects.push_back(obj);
+
+		// Front portal
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(0, 1, 1.0001f), 180);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(0-50, -2, 1.0001f-5);
+		obj->portalNormal = Vec3(0, 0, -1);
+		objects.push_back(obj);
+		
+		// Right portal
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(1.0001f, 1, 0), 270);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(1.0001f-50, -11, 0-5);
+		obj->portalNormal = Vec3(-1, 0, 0);
+		objects.push_back(obj);
+
+		// Left portal
+		obj = ObjParser::LoadMesh("../resources/models/tris/quad.obj");
+		obj->SetTransform(Vec3(-1.0001f, 1, 0), 90);
+		obj->isPortal = 1.0f;
+		obj->portalPosition = Vec3(-1.0001f-50, -8, 0-5);
+		obj->portalNormal = Vec3(1, 0, 0);
+		objects.push_back(obj);
+	}
+
+
+	// Nothing here moves, so the bounds the shader culls with can be exact
+	for (size_t i = first; i < objects.size(); i++)
+		objects[i]->FitAABB();
+}
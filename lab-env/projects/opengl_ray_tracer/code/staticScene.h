@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include "gameObject.h"
+#include "threadPool.h"
+
+
+// The objects that never move, the scene .obj and the portals placed in it.
+// Built from the text files by the scene converter, and by the application
+// when there is no converted scene to load
+class StaticScene
+{
+public:
+
+	static constexpr const char *SceneFile = "../resources/models/ray_tracer_scene.obj";
+	static constexpr const char *ConvertedFile = "../resources/models/ray_tracer_scene.rtscene";
+
+
+	StaticScene();
+	~StaticScene();
+
+	static void Create(std::vector<GameObject*> &objects, ThreadPool &pool);
+};
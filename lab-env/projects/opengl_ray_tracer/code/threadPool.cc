@@ -0,0 +1,141 @@
+#include "threadPool.h"
+
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(int nrThreads)
+{
+	if (nrThreads <= 0)
+		nrThreads = std::max(1, (int)std::thread::hardware_concurrency());
+
+	this->remaining = 0;
+
+	for (int i = 0; i < nrThreads; i++)
+		this->queues.push_back(new Queue());
+
+	// The calling thread works too, so one less worker is needed
+	for (int i = 0; i < nrThreads - 1; i++)
+		this->workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->quit = true;
+	}
+	this->wake.notify_all();
+
+	for (unsigned int i = 0; i < this->workers.size(); i++)
+		this->workers[i].join();
+
+	for (unsigned int i = 0; i < this->queues.size(); i++)
+		delete this->queues[i];
+}
+
+
+int ThreadPool::NrThreads()const
+{
+	return this->queues.size();
+}
+
+void ThreadPool::ParallelFor(const int count, const std::function<void(int)> &task)
+{
+	if (count <= 0)
+		return;
+
+	int nrQueues = this->queues.size();
+	this->task = &task;
+	this->remaining = count;
+
+	// Deal out contiguous ranges so neighbouring tasks start on the same thread
+	for (int q = 0; q < nrQueues; q++)
+	{
+		int begin = (long long)count * q / nrQueues;
+		int end = (long long)count * (q + 1) / nrQueues;
+
+		std::lock_guard<std::mutex> lock(this->queues[q]->mutex);
+		for (int i = begin; i < end; i++)
+			this->queues[q]->items.push_back(i);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->generation++;
+	}
+	this->wake.notify_all();
+
+	// Help out on the calling thread, then wait for the tasks still running
+	this->RunTasks(nrQueues - 1);
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->done.wait(lock, [this]() { return this->remaining == 0; });
+	this->task = nullptr;
+}
+
+
+void ThreadPool::WorkerLoop(const int id)
+{
+	int seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->wake.wait(lock, [&]() { return this->quit || this->generation != seenGeneration; });
+
+			if (this->quit)
+				return;
+
+			seenGeneration = this->generation;
+		}
+
+		this->RunTasks(id);
+	}
+}
+
+bool ThreadPool::PopOrSteal(const int id, int &item)
+{
+	int nrQueues = this->queues.size();
+
+	{
+		Queue *own = this->queues[id];
+		std::lock_guard<std::mutex> lock(own->mutex);
+		if (!own->items.empty())
+		{
+			item = own->items.back();
+			own->items.pop_back();
+			return true;
+		}
+	}
+
+	for (int i = 1; i < nrQueues; i++)
+	{
+		Queue *victim = this->queues[(id + i) % nrQueues];
+		std::lock_guard<std::mutex> lock(victim->mutex);
+		if (!victim->items.empty())
+		{
+			item = victim->items.front();
+			victim->items.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::RunTasks(const int id)
+{
+	int item;
+	while (this->PopOrSteal(id, item))
+	{
+		(*this->task)(item);
+
+		// Last task wakes up the thread waiting in ParallelFor
+		if (--this->remaining == 0)
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->done.notify_all();
+		}
+	}
+}
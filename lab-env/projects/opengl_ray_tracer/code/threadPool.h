@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+
+// Runs the tasks of a parallel loop on a fixed set of worker threads. Every
+// thread has its own queue and steals from the others when it runs out, so
+// tasks of uneven cost (tiles looking through portals) still balance out
+class ThreadPool
+{
+public:
+
+	// 0 threads uses one per hardware thread
+	ThreadPool(int nrThreads = 0);
+	~ThreadPool();
+
+	// Worker threads plus the calling thread
+	int NrThreads()const;
+
+	// Call task(i) for every i in [0, count) and return when all are done.
+	// Not reentrant, a task must not call ParallelFor on the same pool
+	void ParallelFor(const int count, const std::function<void(int)> &task);
+
+private:
+
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<int> items;
+	};
+
+	void WorkerLoop(const int id);
+
+	// Take from the back of our own queue, or from the front of another one
+	bool PopOrSteal(const int id, int &item);
+	void RunTasks(const int id);
+
+	std::vector<std::thread> workers;
+
+	// One queue per worker, the last one belongs to the calling thread
+	std::vector<Queue*> queues;
+
+	const std::function<void(int)> *task = nullptr;
+	std::atomic<int> remaining;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	int generation = 0;
+	bool quit = false;
+};
@@ -0,0 +1,29 @@
+//------------------------------------------------------------------------------
+// convertScene.cc
+// Builds the static scene from the .obj files and writes it in the binary
+// format the application maps straight into its GPU buffer. Run from the bin
+// folder like the application, the build does this when the scene changes.
+//------------------------------------------------------------------------------
+#include "staticScene.h"
+#include "sceneFile.h"
+#include "threadPool.h"
+
+#include <cstdio>
+#include <vector>
+
+
+int main(int argc, const char **argv)
+{
+	const char *output = (argc > 1) ? argv[1] : StaticScene::ConvertedFile;
+
+	std::vector<GameObject*> objects;
+	{
+		ThreadPool pool;
+		StaticScene::Create(objects, pool);
+	}
+
+	bool ok = SceneFile::Write(output, objects);
+	GameObjectPool::DestroyAll();
+
+	return ok ? 0 : 1;
+}
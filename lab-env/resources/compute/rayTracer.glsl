@@ -1,6 +1,7 @@
 #version 430 core
 layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
 layout(rgba32f, binding = 0) uniform image2D frameBuffer;
+layout(rgba32ui, binding = 1) uniform writeonly uimage2D costBuffer;
 
 
 const int MAX_PORTAL_DEPTH = 5;
@@ -8,7 +9,7 @@ const float MAX_SCENE_BOUNDS = 1000.0f;
 const float PI = 3.1415926f;
 const float EPSILON = 0.00001f;
 const vec3 BACKGROUND_COLOR = vec3(0.1f, 0.1f, 0.1f);
-const int constObjSize = 17;
+const int constObjSize = 18;
 
 const mat4 rot90  = mat4(0.0f, 0.0f, 1.0f, 0.0f, 
 						 0.0f, 1.0f, 0.0f, 0.0f,
@@ -43,13 +44,19 @@ layout(std430, binding = 3) buffer StaticVertexBuffer
 			3x float RGB
 			3x float AABB.min
 			3x float AABB.max
+			1x float nrPositions
 			
-			nrFloats *
+			nrPositions *
 			{
 				1x float x
 				1x float y
 				1x float z
 			}
+
+			nrFaces *
+			{
+				nrVerts float position number
+			}
 		}
 	*/
 	float staticBuffer[];
@@ -58,6 +65,21 @@ layout(std430, binding = 4) buffer DynamicVertexBuffer
 {
 	float dynamicBuffer[];
 };
+layout(std430, binding = 5) buffer CostCounterBuffer
+{
+	// Totals over the whole frame, only written in debug mode
+	uint totalAABBTests;
+	uint totalTriangleTests;
+	uint totalPortalHops;
+	uint totalShadowTests;
+};
+layout(std430, binding = 6) buffer RayCounterBuffer
+{
+	// Rays traced this frame, always written
+	uint totalPrimaryRays;
+	uint totalPortalRays;
+	uint totalShadowRays;
+};
 
 
 
@@ -68,6 +90,29 @@ uniform vec3 ray10;
 uniform vec3 ray01;
 uniform vec3 ray11;
 
+// 0 = normal rendering, otherwise write the per-pixel cost to costBuffer
+uniform int debugMode;
+
+
+
+// Per-pixel cost. AABB and triangle tests are counted for camera and portal
+// rays, shadowTests counts every AABB and triangle test of the shadow ray
+uint aabbTests = 0u;
+uint triangleTests = 0u;
+uint portalHops = 0u;
+uint shadowTests = 0u;
+
+// Shadow rays traced by this pixel, portal rays are the same as portalHops
+uint shadowRays = 0u;
+
+// Per work group sums, added to the global totals once per group
+shared uint groupAABBTests;
+shared uint groupTriangleTests;
+shared uint groupPortalHops;
+shared uint groupShadowTests;
+shared uint groupPrimaryRays;
+shared uint groupPortalRays;
+shared uint groupShadowRays;
 
 
 struct Ray
@@ -79,6 +124,7 @@ struct Ray
 struct ObjInfo
 {
 	int nrVerts;
+	int nrPositions;
 	bool isPortal;
 	vec3 exitPortalPosition;
 	vec3 exitPortalNormal;
@@ -164,6 +210,24 @@ bool IntersectTriangle(const Ray ray, const vec3 a, const vec3 ab, const vec3 ac
 }
 
 
+// Position of an object's vertex, positions is where they start in the buffer
+vec3 GetPosition(const int positions, const int index, const bool dynamic)
+{
+	int i = positions + index * 3;
+	if (dynamic)
+		return vec3(dynamicBuffer[i+0], dynamicBuffer[i+1], dynamicBuffer[i+2]);
+	return vec3(staticBuffer[i+0], staticBuffer[i+1], staticBuffer[i+2]);
+}
+
+// Position number of a face corner
+int GetIndex(const int i, const bool dynamic)
+{
+	if (dynamic)
+		return int(dynamicBuffer[i] + 0.5f);
+	return int(staticBuffer[i] + 0.5f);
+}
+
+
 bool IntersectObject(const Ray ray, const ObjInfo obj, const int thisNrValues, const int objStart, const bool dynamic,
 					 out float distance, out HitInfo info)
 {
@@ -171,42 +235,36 @@ bool IntersectObject(const Ray ray, const ObjInfo obj, const int thisNrValues, c
 	float closestTriangle = MAX_SCENE_BOUNDS;
 	vec3 a,b,c,d;
 
+	// The faces follow the positions
+	int firstIndex = objStart + obj.nrPositions * 3;
 	int stop = objStart + thisNrValues - constObjSize;
 
 	if (obj.nrVerts == 3)
 	{
 		// Loop over all triangles in the object
-		for (int i = objStart; i < stop; i+=9)
+		for (int i = firstIndex; i < stop; i+=3)
 		{
-			if (dynamic)
-			{
-				c = vec3(dynamicBuffer[i+0], dynamicBuffer[i+1], dynamicBuffer[i+2]);
-				a = vec3(dynamicBuffer[i+3], dynamicBuffer[i+4], dynamicBuffer[i+5]);
-				b = vec3(dynamicBuffer[i+6], dynamicBuffer[i+7], dynamicBuffer[i+8]);
-			}
-			else
-			{
-				c = vec3(staticBuffer[i+0], staticBuffer[i+1], staticBuffer[i+2]);
-				a = vec3(staticBuffer[i+3], staticBuffer[i+4], staticBuffer[i+5]);
-				b = vec3(staticBuffer[i+6], staticBuffer[i+7], staticBuffer[i+8]);
-			}
+			c = GetPosition(objStart, GetIndex(i+0, dynamic), dynamic);
+			a = GetPosition(objStart, GetIndex(i+1, dynamic), dynamic);
+			b = GetPosition(objStart, GetIndex(i+2, dynamic), dynamic);
 
 			vec3 ab = b - a;
 			vec3 ac = c - a;
 
 			float triangleDistance = MAX_SCENE_BOUNDS;
 			vec2 hitCoords;
+			triangleTests++;
 			bool hitTriangle = IntersectTriangle(ray, a, ab, ac,
 										  triangleDistance, hitCoords);
 
 			if (hitTriangle && triangleDistance < closestTriangle && triangleDistance > 0.0f)
 			{
 				// Hit top-left triangle of portal
-				if (i == objStart)
+				if (i == firstIndex)
 					info.corner = 1;
 								
 				// Hit bottom-right triangle of portal
-				else if (i == objStart+9)
+				else if (i == firstIndex+3)
 					info.corner = 2;
 
 
@@ -230,22 +288,12 @@ bool IntersectObject(const Ray ray, const ObjInfo obj, const int thisNrValues, c
 	else
 	{
 		// Loop over all quads in the object
-		for (int i = objStart; i < stop; i+=12)
+		for (int i = firstIndex; i < stop; i+=4)
 		{
-			if (dynamic)
-			{
-				c = vec3(dynamicBuffer[i+0], dynamicBuffer[i+1], dynamicBuffer[i+2]);
-				a = vec3(dynamicBuffer[i+3], dynamicBuffer[i+4], dynamicBuffer[i+5]);
-				b = vec3(dynamicBuffer[i+6], dynamicBuffer[i+7], dynamicBuffer[i+8]);
-				d = vec3(dynamicBuffer[i+9], dynamicBuffer[i+10], dynamicBuffer[i+11]);
-			}
-			else
-			{
-				c = vec3(staticBuffer[i+0], staticBuffer[i+1], staticBuffer[i+2]);
-				a = vec3(staticBuffer[i+3], staticBuffer[i+4], staticBuffer[i+5]);
-				b = vec3(staticBuffer[i+6], staticBuffer[i+7], staticBuffer[i+8]);
-				d = vec3(staticBuffer[i+9], staticBuffer[i+10], staticBuffer[i+11]);
-			}
+			c = GetPosition(objStart, GetIndex(i+0, dynamic), dynamic);
+			a = GetPosition(objStart, GetIndex(i+1, dynamic), dynamic);
+			b = GetPosition(objStart, GetIndex(i+2, dynamic), dynamic);
+			d = GetPosition(objStart, GetIndex(i+3, dynamic), dynamic);
 
 			vec3 ab = b - a;
 			vec3 ac = c - a;
@@ -254,6 +302,7 @@ bool IntersectObject(const Ray ray, const ObjInfo obj, const int thisNrValues, c
 
 			float triangleDistance = MAX_SCENE_BOUNDS;
 			vec2 hitCoords;
+			triangleTests++;
 			bool hitTriangle = IntersectTriangle(ray, a, ab, ac,
 													triangleDistance, hitCoords);
 			
@@ -273,6 +322,7 @@ bool IntersectObject(const Ray ray, const ObjInfo obj, const int thisNrValues, c
 			}
 
 			
+			triangleTests++;
 			hitTriangle = IntersectTriangle(ray, d, dc, db,
 											triangleDistance, hitCoords);
 			if (hitTriangle && triangleDistance < closestTriangle && triangleDistance > 0.0f)
@@ -350,6 +400,7 @@ bool IntersectScene(const Ray ray,
 			obj.color 				= vec3(staticBuffer[objStart+8], staticBuffer[objStart+9], staticBuffer[objStart+10]);
 			aabb.min 				= vec3(staticBuffer[objStart+11], staticBuffer[objStart+12], staticBuffer[objStart+13]);
 			aabb.max 				= vec3(staticBuffer[objStart+14], staticBuffer[objStart+15], staticBuffer[objStart+16]);
+			obj.nrPositions 		=  int(staticBuffer[objStart+17] + 0.5f);
 		}
 		else
 		{
@@ -361,10 +412,12 @@ bool IntersectScene(const Ray ray,
 			obj.color 				= vec3(dynamicBuffer[objStart+8], dynamicBuffer[objStart+9], dynamicBuffer[objStart+10]);
 			aabb.min 				= vec3(dynamicBuffer[objStart+11], dynamicBuffer[objStart+12], dynamicBuffer[objStart+13]);
 			aabb.max 				= vec3(dynamicBuffer[objStart+14], dynamicBuffer[objStart+15], dynamicBuffer[objStart+16]);
+			obj.nrPositions 		=  int(dynamicBuffer[objStart+17] + 0.5f);
 		}
 
 
 		// Check if ray is hitting the AABB
+		aabbTests++;
 		vec2 aabbHit = IntersectAABB(ray, aabb);
 		if (aabbHit.y > 0.0f && aabbHit.x <= aabbHit.y && aabbHit.x < closestAABBFar)
 		{
@@ -398,35 +451,29 @@ bool IntersectScene(const Ray ray,
 }
 
 
-bool ShadowIntersectObject(const Ray ray, const int nrVerts, const int thisNrValues, const int objStart, const bool dynamic)
+bool ShadowIntersectObject(const Ray ray, const int nrVerts, const int nrPositions, const int thisNrValues, const int objStart, const bool dynamic)
 {
 	vec3 a,b,c,d;
 
+	// The faces follow the positions
+	int firstIndex = objStart + nrPositions * 3;
 	int stop = objStart + thisNrValues - constObjSize;
 
 	if (nrVerts == 3)
 	{
 		// Loop over all triangles in the object
-		for (int i = objStart; i < stop; i+=9)
+		for (int i = firstIndex; i < stop; i+=3)
 		{
-			if (dynamic)
-			{
-				c = vec3(dynamicBuffer[i+0], dynamicBuffer[i+1], dynamicBuffer[i+2]);
-				a = vec3(dynamicBuffer[i+3], dynamicBuffer[i+4], dynamicBuffer[i+5]);
-				b = vec3(dynamicBuffer[i+6], dynamicBuffer[i+7], dynamicBuffer[i+8]);
-			}
-			else
-			{
-				c = vec3(staticBuffer[i+0], staticBuffer[i+1], staticBuffer[i+2]);
-				a = vec3(staticBuffer[i+3], staticBuffer[i+4], staticBuffer[i+5]);
-				b = vec3(staticBuffer[i+6], staticBuffer[i+7], staticBuffer[i+8]);
-			}
+			c = GetPosition(objStart, GetIndex(i+0, dynamic), dynamic);
+			a = GetPosition(objStart, GetIndex(i+1, dynamic), dynamic);
+			b = GetPosition(objStart, GetIndex(i+2, dynamic), dynamic);
 
 			vec3 ab = b - a;
 			vec3 ac = c - a;
 
 			vec2 hitCoords;
 			float triangleDistance;
+			shadowTests++;
 			bool hitTriangle = IntersectTriangle(ray, a, ab, ac,
 										  triangleDistance, hitCoords);
 
@@ -437,22 +484,12 @@ bool ShadowIntersectObject(const Ray ray, const int nrVerts, const int thisNrVal
 	else
 	{
 		// Loop over all quads in the object
-		for (int i = objStart; i < stop; i+=12)
+		for (int i = firstIndex; i < stop; i+=4)
 		{
-			if (dynamic)
-			{
-				c = vec3(dynamicBuffer[i+0], dynamicBuffer[i+1], dynamicBuffer[i+2]);
-				a = vec3(dynamicBuffer[i+3], dynamicBuffer[i+4], dynamicBuffer[i+5]);
-				b = vec3(dynamicBuffer[i+6], dynamicBuffer[i+7], dynamicBuffer[i+8]);
-				d = vec3(dynamicBuffer[i+9], dynamicBuffer[i+10], dynamicBuffer[i+11]);
-			}
-			else
-			{
-				c = vec3(staticBuffer[i+0], staticBuffer[i+1], staticBuffer[i+2]);
-				a = vec3(staticBuffer[i+3], staticBuffer[i+4], staticBuffer[i+5]);
-				b = vec3(staticBuffer[i+6], staticBuffer[i+7], staticBuffer[i+8]);
-				d = vec3(staticBuffer[i+9], staticBuffer[i+10], staticBuffer[i+11]);
-			}
+			c = GetPosition(objStart, GetIndex(i+0, dynamic), dynamic);
+			a = GetPosition(objStart, GetIndex(i+1, dynamic), dynamic);
+			b = GetPosition(objStart, GetIndex(i+2, dynamic), dynamic);
+			d = GetPosition(objStart, GetIndex(i+3, dynamic), dynamic);
 			
 			vec3 ab = b - a;
 			vec3 ac = c - a;
@@ -461,6 +498,7 @@ bool ShadowIntersectObject(const Ray ray, const int nrVerts, const int thisNrVal
 
 			float triangleDistance;
 			vec2 hitCoords;
+			shadowTests++;
 			bool hitTriangle = IntersectTriangle(ray, a, ab, ac,
 												 triangleDistance, hitCoords);
 			
@@ -468,6 +506,7 @@ bool ShadowIntersectObject(const Ray ray, const int nrVerts, const int thisNrVal
 				return true;
 
 			
+			shadowTests++;
 			hitTriangle = IntersectTriangle(ray, d, dc, db,
 											triangleDistance, hitCoords);
 			if (hitTriangle && triangleDistance > 0.0f)
@@ -507,6 +546,7 @@ bool ShadowIntersectScene(const Ray ray)
 			obj.isPortal 	=     (staticBuffer[objStart+1] > 0.5f);
 			aabb.min 		= vec3(staticBuffer[objStart+11], staticBuffer[objStart+12], staticBuffer[objStart+13]);
 			aabb.max 		= vec3(staticBuffer[objStart+14], staticBuffer[objStart+15], staticBuffer[objStart+16]);
+			obj.nrPositions =  int(staticBuffer[objStart+17] + 0.5f);
 		}
 		else
 		{
@@ -515,6 +555,7 @@ bool ShadowIntersectScene(const Ray ray)
 			obj.isPortal 	= 	  (dynamicBuffer[objStart+1] > 0.5f);
 			aabb.min 		= vec3(dynamicBuffer[objStart+11], dynamicBuffer[objStart+12], dynamicBuffer[objStart+13]);
 			aabb.max 		= vec3(dynamicBuffer[objStart+14], dynamicBuffer[objStart+15], dynamicBuffer[objStart+16]);
+			obj.nrPositions =  int(dynamicBuffer[objStart+17] + 0.5f);
 		}
 
 
@@ -522,11 +563,12 @@ bool ShadowIntersectScene(const Ray ray)
 		if (!obj.isPortal)
 		{
 			// Check if ray is hitting the AABB
+			shadowTests++;
 			vec2 aabbHit = IntersectAABB(ray, aabb);
 			if (aabbHit.x <= aabbHit.y)
 			{
 				// Check if the ray is hitting any triangle in the mesh
-				if (ShadowIntersectObject(ray, obj.nrVerts, thisNrValues, objStart + constObjSize, (i >= nrStaticObjects)))
+				if (ShadowIntersectObject(ray, obj.nrVerts, obj.nrPositions, thisNrValues, objStart + constObjSize, (i >= nrStaticObjects)))
 					return true;
 
 			}
@@ -642,6 +684,7 @@ vec3 Trace(Ray ray, const ivec2 coord)
 
 		// Make sure we don't get stuck in an infinite loop
 		portalDepth++;
+		portalHops++;
 	}
 
 	// Set the pixel color to color of the object hit
@@ -655,8 +698,12 @@ vec3 Trace(Ray ray, const ivec2 coord)
 	ray.dir = normalize(light);
 
 	// If the shadow ray intersects something
-	if (hitSomething && ShadowIntersectScene(ray))
-		color *= 0.4f;
+	if (hitSomething)
+	{
+		shadowRays++;
+		if (ShadowIntersectScene(ray))
+			color *= 0.4f;
+	}
 
 
 	return color;
@@ -668,23 +715,78 @@ void main()
 	ivec2 pixelCoord = ivec2(gl_GlobalInvocationID.xy);
 	ivec2 size = imageSize(frameBuffer);
 
-	// Make sure the pixel is inside the bounds of the frame (Do I need this?)
-	if (pixelCoord.x >= size.x || pixelCoord.y >= size.y)
-		return;
-	
+	if (gl_LocalInvocationIndex == 0)
+	{
+		groupPrimaryRays = 0u;
+		groupPortalRays = 0u;
+		groupShadowRays = 0u;
+
+		groupAABBTests = 0u;
+		groupTriangleTests = 0u;
+		groupPortalHops = 0u;
+		groupShadowTests = 0u;
+	}
 
-	// Create ray
-	Ray ray;
-	ray.origin = eye;
+	// Make sure the pixel is inside the bounds of the frame. No early return,
+	// every invocation has to reach the barriers below
+	bool insideFrame = (pixelCoord.x < size.x && pixelCoord.y < size.y);
+	if (insideFrame)
+	{
+		// Create ray
+		Ray ray;
+		ray.origin = eye;
 
-	vec2 pos = vec2(pixelCoord) / vec2(size.x, size.y);
-	ray.dir = mix(mix(ray00, ray01, pos.y), mix(ray10, ray11, pos.y), pos.x);
+		vec2 pos = vec2(pixelCoord) / vec2(size.x, size.y);
+		ray.dir = mix(mix(ray00, ray01, pos.y), mix(ray10, ray11, pos.y), pos.x);
 
 
-	// Trace the ray for this pixel
-	vec3 color = Trace(ray, pixelCoord);
-	
+		// Trace the ray for this pixel
+		vec3 color = Trace(ray, pixelCoord);
+		
+
+		// Save the output to the texture
+		imageStore(frameBuffer, pixelCoord, vec4(color, 1.0f));
+	}
+
 
-	// Save the output to the texture
-	imageStore(frameBuffer, pixelCoord, vec4(color, 1.0f));
-}
\ No newline at end of file
+	// Sum the counters of the work group
+	memoryBarrierShared();
+	barrier();
+
+	if (insideFrame)
+	{
+		atomicAdd(groupPrimaryRays, 1u);
+		atomicAdd(groupPortalRays, portalHops);
+		atomicAdd(groupShadowRays, shadowRays);
+
+		// Per-pixel cost in debug mode
+		if (debugMode != 0)
+		{
+			imageStore(costBuffer, pixelCoord, uvec4(aabbTests, triangleTests, portalHops, shadowTests));
+
+			atomicAdd(groupAABBTests, aabbTests);
+			atomicAdd(groupTriangleTests, triangleTests);
+			atomicAdd(groupPortalHops, portalHops);
+			atomicAdd(groupShadowTests, shadowTests);
+		}
+	}
+
+	memoryBarrierShared();
+	barrier();
+
+	// One global atomic per work group instead of one per pixel
+	if (gl_LocalInvocationIndex == 0)
+	{
+		atomicAdd(totalPrimaryRays, groupPrimaryRays);
+		atomicAdd(totalPortalRays, groupPortalRays);
+		atomicAdd(totalShadowRays, groupShadowRays);
+
+		if (debugMode != 0)
+		{
+			atomicAdd(totalAABBTests, groupAABBTests);
+			atomicAdd(totalTriangleTests, groupTriangleTests);
+			atomicAdd(totalPortalHops, groupPortalHops);
+			atomicAdd(totalShadowTests, groupShadowTests);
+		}
+	}
+}